@@ -1,4 +1,5 @@
 #include "binding.h"
+#include "config.h"
 #include "geometry.h"
 #include "layout.h"
 #include "logger.h"
@@ -48,7 +49,7 @@ static auto _get_node_pos_by_direction_impl(const Node<Container>& node, Directi
     -> Node<Container>::const_iterator
 {
     const auto& parent = node.parent_unsafe().get<Layout>();
-    const auto node_it = std::ranges::find(parent, node);
+    const auto node_it = parent.iterator_to(node);
 
     switch (dir) {
         case prev:
@@ -113,6 +114,25 @@ static auto _find_direction_compatible_node(Node<Container>& node, Direction dir
     }
 }
 
+// Resize needs a split along the direction axis, tabbed layouts have no edge to move.
+static auto _find_resizable_node(Node<Container>& node, Direction dir) noexcept
+    -> std::optref<Node<Container>>
+{
+    assert(node.parent());
+    assert(!node.parent_unsafe().is_root());
+    const auto type = (dir == Direction::Left || dir == Direction::Right)
+            ? Layout::Containment_type::Horizontal
+            : Layout::Containment_type::Vertical;
+    auto *current = &node;
+
+    while (!current->parent_unsafe().is_root()) {
+        auto& parent = current->parent_unsafe().get<Layout>();
+        if (parent.type() == type && parent.size() > 1) return *current;
+        current = &parent;
+    }
+    return std::nullopt;
+}
+
 static auto _get_current_focused_container(State& state) noexcept
     -> std::optref<Node<Container>>
 {
@@ -141,10 +161,29 @@ static inline void _direction_action(auto&& prev_fn, auto&& next_fn, Direction d
 void Move_focus::execute(State& state) const noexcept
 {
     const auto& objref = _get_current_focused_container(state);
+    Monitor& current   = state.current_monitor();
+    // Empty workspace looks from its monitor, so focus can still leave it.
+    const Window*   window = objref ? &objref->get().get<Window>() : nullptr;
+    const Vector2D& from   = window ? window->rect() : current.workarea();
+
+    if (const auto hit = current.spatial_index().nearest(from, _dir, window); hit.window) {
+        state.current_workspace().focus_window(*hit.window);
+        return;
+    }
+    // Nothing on this monitor, the next one that way gets focus even if it shows no window.
+    if (const auto& monref = monitor::find_adjacent(state.monitors(), current, _dir)) {
+        Workspace& workspace = monref->get().current();
+        const auto hit = monref->get().spatial_index().nearest(from, _dir, nullptr);
+        state.switch_workspace(workspace);
+        if (hit.window) workspace.focus_window(*hit.window);
+        return;
+    }
     if (!objref.has_value()) return;
 
     Node<Container>& object = objref->get();
 
+    // Nothing in that direction, wrap around within the layout.
+
     if (const auto& noderef = _find_direction_compatible_node(object, _dir)) {
         const auto& node = noderef->get();
         const auto& parent = node.parent_unsafe();
@@ -170,7 +209,7 @@ static void _move_to_adjacent_node(Window& window, Node<Container>& node, Direct
 {
     assert(node.parent());
     auto& parent = node.parent_unsafe().get<Layout>();
-    auto node_it = std::ranges::find(parent, node);
+    auto node_it = parent.iterator_to(node);
 
     // Unmark window if marked.
     window.unmark_layout();
@@ -247,6 +286,7 @@ static void _move_to_top_node(Window& window, Workspace& workspace, Direction di
         // Silent this stupid warning, if new fails, just let the program go boom.
         auto* layout = new Layout(_get_inverse_layout_type(top_layout.type()));
         workspace.remove_child(top_layout);
+        top_layout.weight(1.0f);
 
         switch (dir) {
             case Direction::Up:
@@ -262,6 +302,8 @@ static void _move_to_top_node(Window& window, Workspace& workspace, Direction di
         }
 
         workspace.add_child(*layout);
+        // Top layout is no longer on top, it might be a useless level now.
+        layout::compact(top_layout);
     }
     workspace.update_rect();
 }
@@ -311,10 +353,69 @@ void Change_layout_type::execute(State& state) const noexcept
     }
 }
 
+void Resize::execute(State& state) const noexcept
+{
+    const auto& objref = _get_current_focused_container(state);
+    if (!objref.has_value()) return;
+
+    if (const auto& noderef = _find_resizable_node(objref->get(), _dir)) {
+        auto& node   = noderef->get();
+        auto& parent = node.parent_unsafe().get<Layout>();
+
+        // Move the edge on the arrow side outward, or the opposite edge inward
+        // when node has no sibling there, so the edge always follows the arrow.
+        const auto node_it = parent.iterator_to(node);
+        auto sibling_it    = parent.cend();
+        float delta        = config::RESIZE_STEP;
+        _direction_action(
+                [&]() {
+                    if (node_it != parent.cbegin()) {
+                        sibling_it = std::ranges::prev(node_it);
+                    } else {
+                        sibling_it = std::ranges::next(node_it);
+                        delta      = -delta;
+                    }
+                },
+                [&]() {
+                    sibling_it = std::ranges::next(node_it);
+                    if (sibling_it == parent.cend()) {
+                        sibling_it = std::ranges::prev(node_it);
+                        delta      = -delta;
+                    }
+                },
+                _dir);
+        logger::debug("Resize -> direction: {}, delta: {}", direction_to_str(_dir), delta);
+        parent.resize(node, *sibling_it, delta);
+    }
+}
+
+void Change_gap::execute(State& state) const noexcept
+{
+    const auto gap = (uint32_t)std::clamp((int)config::gap_size + _delta, 0, (int)config::MAX_GAP_SIZE);
+    if (gap == config::gap_size) return;
+    logger::debug("Change gap -> size: {}", gap);
+    config::gap_size = gap;
+    monitor::update_rect_all(state.monitors());
+}
+
+#ifndef NDEBUG
+void Check_state::execute(State& state) const noexcept
+{
+    state.check();
+}
+#endif
+
 void Switch_workspace::execute(State& state) const noexcept
 {
     if (state.current_workspace().index() != _workspace_id)
         state.switch_workspace(state.get_or_create_workspace(_workspace_id));
 }
 
+void Move_to_workspace::execute(State& state) const noexcept
+{
+    const auto& objref = _get_current_focused_container(state);
+    if (!objref.has_value() || state.current_workspace().index() == _workspace_id) return;
+    state.move_container_to_workspace(objref->get(), state.get_or_create_workspace(_workspace_id));
+}
+
 } // namespace binding
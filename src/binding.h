@@ -53,6 +53,33 @@ public:
     void execute(State& state) const noexcept override;
 };
 
+// Move an edge of the container toward the arrow, the one on the arrow side
+// if it has a sibling there, else the opposite one.
+class Resize : public Binding
+{
+    Direction _dir;
+public:
+    Resize(const Index& k, Direction dir) noexcept
+        : Binding(k)
+        , _dir(dir)
+    {}
+
+    void execute(State& state) const noexcept override;
+};
+
+// Grow or shrink gaps, every monitor is laid out again.
+class Change_gap : public Binding
+{
+    int _delta;
+public:
+    Change_gap(const Index& k, int delta) noexcept
+        : Binding(k)
+        , _delta(delta)
+    {}
+
+    void execute(State& state) const noexcept override;
+};
+
 class Switch_workspace : public Binding
 {
     uint32_t _workspace_id;
@@ -64,6 +91,31 @@ public:
 
     void execute(State& state) const noexcept override;
 };
+// Moves focused container to workspace, creating it if needed.
+class Move_to_workspace : public Binding
+{
+    uint32_t _workspace_id;
+public:
+    Move_to_workspace(const Index& k, uint32_t index) noexcept
+        : Binding(k)
+        , _workspace_id(index)
+    {}
+
+    void execute(State& state) const noexcept override;
+};
+
+#ifndef NDEBUG
+// Debug only, checks state against the display server.
+class Check_state : public Binding
+{
+public:
+    explicit Check_state(const Index& k) noexcept
+        : Binding(k)
+    {}
+
+    void execute(State& state) const noexcept override;
+};
+#endif
 } //namespace binding
 
 // If we need custom parameter so desperately, we can use buffer pattern
\ No newline at end of file
@@ -1,6 +1,10 @@
+#include "config.h"
+
 namespace config
 {
 bool replace_wm      = false;
 bool enable_xinerama = false;
 bool enable_randr    = true;
+Hide_mode hide_mode  = Hide_mode::Unmap;
+uint32_t gap_size    = 4;
 }
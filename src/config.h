@@ -1,4 +1,5 @@
 #pragma once
+#include <string_view>
 #include <xcb/xproto.h>
 
 /**
@@ -10,7 +11,15 @@ namespace config
 
 // Constants
 
-static constexpr uint32_t GAP_SIZE = 4;
+// Gap changed per step, gap_size stays below MAX_GAP_SIZE.
+static constexpr int      GAP_STEP     = 2;
+static constexpr uint32_t MAX_GAP_SIZE = 64;
+
+// Weight moved per resize, in fraction of both resized containers.
+static constexpr float RESIZE_STEP = 0.05f;
+
+// Minimum share a container keeps when resized.
+static constexpr float MIN_RESIZE_RATIO = 0.1f;
 
 static constexpr std::string_view WM_NAME = "CubeWM";
 
@@ -31,14 +40,17 @@ static constexpr int FRAME_EVENT_MASK = XCB_EVENT_MASK_BUTTON_PRESS          /*
                                       | XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY   /* …subwindows get notifies */
                                       | XCB_EVENT_MASK_ENTER_WINDOW;         /* …user moves cursor inside our window */
 
+// No pointer motion, it would wake us on every mouse move.
 static constexpr int ROOT_EVENT_MASK = XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT
                                      | XCB_EVENT_MASK_BUTTON_PRESS
                                      | XCB_EVENT_MASK_STRUCTURE_NOTIFY
-                                     | XCB_EVENT_MASK_POINTER_MOTION
                                      | XCB_EVENT_MASK_PROPERTY_CHANGE
                                      | XCB_EVENT_MASK_FOCUS_CHANGE
                                      | XCB_EVENT_MASK_ENTER_WINDOW;
 
+// ConfigureRequests per second before a client is flagged as spamming.
+static constexpr uint32_t CONFIGURE_REQUEST_LIMIT = 30;
+
 static constexpr std::string_view FRAME_CLASS_NAME = "cube-frame";
 
 } // namespace X11
@@ -51,4 +63,15 @@ extern bool enable_xinerama;
 
 extern bool enable_randr;
 
+enum class Hide_mode : uint8_t
+{
+    Unmap,     // Unmap hidden windows
+    Offscreen, // Keep hidden windows mapped, but out of every monitor
+};
+
+extern Hide_mode hide_mode;
+
+// Space around tiled windows and inside workspace edges, changed by a binding.
+extern uint32_t gap_size;
+
 } // namespace config
@@ -8,10 +8,14 @@
 #include "geometry.h"
 
 #include <cassert>
+#include <concepts>
+#include <type_traits>
 
 class Container
 {
     Vector2D _rect;
+    // Share of the parent layout, relative to its siblings.
+    float    _weight = 1.0f;
     bool     _focused{};
 
 protected: // To avoid ambiguous name.
@@ -34,6 +38,30 @@ public:
     }
     inline void update_rect() noexcept
     { _update_rect_fn(); }
+    // Set rect without laying out children, their rects are computed ahead.
+    inline void assign_rect(const Vector2D& rect) noexcept
+    { _rect = rect; }
+
+    /**
+     * @brief Same as rect(rect), but dispatched statically.
+     * Used by layout cascade, where the type is known by node tag.
+     * @tparam Derived Final type of this container
+     */
+    template <std::derived_from<Container> Derived>
+    requires (std::is_final_v<Derived>)
+    inline void rect(const Vector2D& rect) noexcept
+    {
+        _rect = rect;
+        static_cast<Derived*>(this)->Derived::_update_rect_fn();
+    }
+
+    inline auto weight() const noexcept -> float
+    { return _weight; }
+    inline void weight(float weight) noexcept
+    {
+        assert(weight > 0);
+        _weight = weight;
+    }
 
     inline bool focused() const noexcept
     { return _focused; }
@@ -19,6 +19,17 @@ struct Vector2D
     }
 };
 
+// Space reserved at each edge of a monitor, such as by docks.
+struct Strut
+{
+    int left   = 0;
+    int right  = 0;
+    int top    = 0;
+    int bottom = 0;
+
+    friend constexpr bool operator==(const Strut&, const Strut&) = default;
+};
+
 enum class Direction : unsigned char
 {
     Left,
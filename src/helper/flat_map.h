@@ -0,0 +1,124 @@
+#pragma once
+#include "../error.h"
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace helper {
+
+/**
+ * @brief Open addressing hash map with linear probing.
+ * Entries are stored inline, erase shifts following entries back,
+ * so there are no tombstones and a miss stops at the first free entry.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class Flat_map
+{
+    struct _Entry
+    {
+        bool  used = false;
+        Key   key{};
+        Value value{};
+    };
+
+    std::vector<_Entry> _entries;
+    std::size_t         _size  = 0;
+    // Capacity is 2^(64 - _shift).
+    unsigned            _shift = 64;
+
+    // Fibonacci hashing spreads sequential ids over the table.
+    inline auto _home(const Key& key) const noexcept -> std::size_t
+    { return (uint64_t(Hash{}(key)) * 0x9E3779B97F4A7C15ull) >> _shift; }
+
+    inline auto _mask() const noexcept -> std::size_t
+    { return _entries.size() - 1; }
+
+    inline auto _find_entry(const Key& key) const noexcept -> const _Entry*
+    {
+        if (_entries.empty()) return nullptr;
+        for (std::size_t i = _home(key);; i = (i + 1) & _mask()) {
+            const _Entry& entry = _entries[i];
+            if (!entry.used) return nullptr;
+            if (entry.key == key) return &entry;
+        }
+    }
+
+    void _rehash(std::size_t capacity)
+    {
+        std::vector<_Entry> old(capacity);
+        old.swap(_entries);
+        _shift = 64 - std::countr_zero(capacity);
+        _size  = 0;
+        for (auto& entry : old)
+            if (entry.used) emplace(entry.key, std::move(entry.value));
+    }
+
+public:
+    inline bool empty() const noexcept
+    { return !_size; }
+
+    inline auto size() const noexcept -> std::size_t
+    { return _size; }
+
+    inline auto find(const Key& key) noexcept -> Value*
+    {
+        const _Entry* entry = _find_entry(key);
+        return (entry) ? &const_cast<_Entry*>(entry)->value : nullptr;
+    }
+
+    inline auto find(const Key& key) const noexcept -> const Value*
+    {
+        const _Entry* entry = _find_entry(key);
+        return (entry) ? &entry->value : nullptr;
+    }
+
+    inline bool contains(const Key& key) const noexcept
+    { return _find_entry(key); }
+
+    // returns false if key already exists.
+    bool emplace(const Key& key, Value value)
+    {
+        // Keep load factor at most 3/4.
+        if ((_size + 1) * 4 > _entries.size() * 3)
+            _rehash(_entries.empty() ? 16 : _entries.size() * 2);
+
+        for (std::size_t i = _home(key);; i = (i + 1) & _mask()) {
+            _Entry& entry = _entries[i];
+            if (!entry.used) {
+                entry = {true, key, std::move(value)};
+                ++_size;
+                return true;
+            }
+            if (entry.key == key) return false;
+        }
+    }
+
+    // returns false if key doesn't exist.
+    bool erase(const Key& key) noexcept
+    {
+        const _Entry* found = _find_entry(key);
+        if (!found) return false;
+
+        auto hole = static_cast<std::size_t>(found - _entries.data());
+        for (std::size_t i = (hole + 1) & _mask(); _entries[i].used; i = (i + 1) & _mask()) {
+            // Move entry back if the hole lies between its home and itself.
+            const std::size_t home = _home(_entries[i].key);
+            if (((i - home) & _mask()) >= ((i - hole) & _mask())) {
+                _entries[hole] = std::move(_entries[i]);
+                hole = i;
+            }
+        }
+        _entries[hole] = _Entry{};
+        --_size;
+        return true;
+    }
+
+    void clear() noexcept
+    {
+        for (auto& entry : _entries) entry = _Entry{};
+        _size = 0;
+    }
+};
+
+} // namespace helper
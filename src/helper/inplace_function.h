@@ -0,0 +1,95 @@
+#pragma once
+#include "../error.h"
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace helper {
+
+template <typename Signature, std::size_t Capacity = 32>
+class Inplace_function;
+
+/**
+ * @brief Type erased callable stored in an inline buffer, never allocates.
+ * Callable must fit in Capacity bytes.
+ */
+template <typename R, typename...Args, std::size_t Capacity>
+class Inplace_function<R(Args...), Capacity> final
+{
+    using _Invoke_fn = R (*)(const void*, Args&&...);
+    using _Copy_fn   = void (*)(void*, const void*);
+    using _Dtor_fn   = void (*)(void*);
+
+    alignas(std::max_align_t) std::byte _storage[Capacity];
+    _Invoke_fn _invoke = nullptr;
+    _Copy_fn   _copy   = nullptr;
+    _Dtor_fn   _dtor   = nullptr;
+
+    void _reset() noexcept
+    {
+        if (_dtor) _dtor(_storage);
+        _invoke = nullptr;
+        _copy   = nullptr;
+        _dtor   = nullptr;
+    }
+
+    void _assign(const Inplace_function& other)
+    {
+        if (other._copy) other._copy(_storage, other._storage);
+        _invoke = other._invoke;
+        _copy   = other._copy;
+        _dtor   = other._dtor;
+    }
+
+public:
+    Inplace_function() noexcept = default;
+
+    template <typename Func>
+    requires (!std::is_same_v<std::remove_cvref_t<Func>, Inplace_function>
+           && std::is_invocable_r_v<R, const std::decay_t<Func>&, Args...>)
+    Inplace_function(Func&& func)
+    {
+        using Fn = std::decay_t<Func>;
+        static_assert(sizeof(Fn) <= Capacity, "Callable too large for inline storage");
+        static_assert(alignof(Fn) <= alignof(std::max_align_t), "Callable over-aligned");
+        static_assert(std::is_copy_constructible_v<Fn>);
+
+        ::new (_storage) Fn(std::forward<Func>(func));
+        _invoke = [](const void* fn, Args&&... args) -> R {
+            return (*static_cast<const Fn*>(fn))(std::forward<Args>(args)...);
+        };
+        _copy = [](void* dst, const void* src) {
+            ::new (dst) Fn(*static_cast<const Fn*>(src));
+        };
+        _dtor = [](void* fn) {
+            static_cast<Fn*>(fn)->~Fn();
+        };
+    }
+
+    Inplace_function(const Inplace_function& other)
+    { _assign(other); }
+
+    auto operator=(const Inplace_function& other) -> Inplace_function&
+    {
+        if (this != &other) {
+            _reset();
+            _assign(other);
+        }
+        return *this;
+    }
+
+    ~Inplace_function()
+    { _reset(); }
+
+    inline explicit operator bool() const noexcept
+    { return _invoke; }
+
+    inline auto operator()(Args... args) const -> R
+    {
+        assert(_invoke);
+        return _invoke(_storage, std::forward<Args>(args)...);
+    }
+};
+
+} // namespace helper
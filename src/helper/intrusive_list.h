@@ -0,0 +1,186 @@
+#pragma once
+#include "../error.h"
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
+namespace helper {
+
+template <typename T>
+class Intrusive_list;
+
+/**
+ * @brief Links embedded in T, so T can be in one Intrusive_list<T> at a time.
+ */
+template <typename T>
+class List_hook
+{
+    friend class Intrusive_list<T>;
+
+    T*   _prev   = nullptr;
+    T*   _next   = nullptr;
+    // No owner pointer, so splicing doesn't touch the spliced elements.
+    bool _linked = false;
+
+public:
+    inline bool is_linked() const noexcept
+    { return _linked; }
+};
+
+/**
+ * @brief Doubly linked list over List_hook, insert and erase never allocate.
+ * Splice and swap are O(1).
+ * Elements aren't owned and aren't unlinked when the list is destroyed.
+ */
+template <typename T>
+class Intrusive_list
+{
+    T*          _first = nullptr;
+    T*          _last  = nullptr;
+    std::size_t _size  = 0;
+
+    static inline auto _hook(T& t) noexcept -> List_hook<T>&
+    { return static_cast<List_hook<T>&>(t); }
+
+public:
+    class iterator final
+    {
+        T* _node = nullptr;
+
+    public:
+        using difference_type   = std::ptrdiff_t;
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = T;
+        using pointer           = T*;
+        using reference         = T&;
+
+        iterator() noexcept = default;
+        explicit iterator(T* node) noexcept : _node(node) {}
+
+        auto operator*()     const noexcept -> reference
+        { return *_node; }
+        auto operator->()    const noexcept -> pointer
+        { return _node; }
+        auto operator++()    noexcept -> iterator&
+        { _node = _hook(*_node)._next; return *this; }
+        auto operator++(int) noexcept -> iterator
+        { auto it = *this; ++*this; return it; }
+
+        friend bool operator==(const iterator& rhs, const iterator& lhs) noexcept
+        { return rhs._node == lhs._node; }
+    };
+    using const_iterator = iterator;
+
+    Intrusive_list() noexcept = default;
+
+    Intrusive_list(const Intrusive_list&)          = delete;
+    auto operator=(const Intrusive_list&)          = delete;
+
+    inline auto begin() const noexcept -> iterator
+    { return iterator(_first); }
+
+    inline auto end()   const noexcept -> iterator
+    { return iterator(); }
+
+    inline bool empty() const noexcept
+    { return !_first; }
+
+    inline auto size() const noexcept -> std::size_t
+    { return _size; }
+
+    inline auto front() const noexcept -> T&
+    {
+        assert(_first);
+        return *_first;
+    }
+
+    // O(n), meant for assertions.
+    inline bool contains(const T& t) const noexcept
+    {
+        for (const auto& e : *this)
+            if (&e == &t) return true;
+        return false;
+    }
+
+    void push_front(T& t) noexcept
+    {
+        auto& hook = _hook(t);
+        assert(!hook._linked);
+        hook._linked = true;
+        hook._prev   = nullptr;
+        hook._next   = _first;
+        (_first) ? _hook(*_first)._prev = &t : _last = &t;
+        _first = &t;
+        ++_size;
+    }
+
+    void push_back(T& t) noexcept
+    {
+        auto& hook = _hook(t);
+        assert(!hook._linked);
+        hook._linked = true;
+        hook._prev   = _last;
+        hook._next   = nullptr;
+        (_last) ? _hook(*_last)._next = &t : _first = &t;
+        _last = &t;
+        ++_size;
+    }
+
+    void erase(T& t) noexcept
+    {
+        auto& hook = _hook(t);
+        assert(hook._linked);
+        (hook._prev) ? _hook(*hook._prev)._next = hook._next : _first = hook._next;
+        (hook._next) ? _hook(*hook._next)._prev = hook._prev : _last  = hook._prev;
+        hook._prev   = nullptr;
+        hook._next   = nullptr;
+        hook._linked = false;
+        --_size;
+    }
+
+    // Move all elements of other before the first one, leaving other empty.
+    void splice_front(Intrusive_list& other) noexcept
+    {
+        assert(&other != this);
+        if (other.empty()) return;
+        if (_first) {
+            _hook(*other._last)._next = _first;
+            _hook(*_first)._prev      = other._last;
+        } else _last = other._last;
+        _first = other._first;
+        _size += other._size;
+        other._first = other._last = nullptr;
+        other._size  = 0;
+    }
+
+    // Move all elements of other after the last one, leaving other empty.
+    void splice_back(Intrusive_list& other) noexcept
+    {
+        assert(&other != this);
+        if (other.empty()) return;
+        if (_last) {
+            _hook(*_last)._next        = other._first;
+            _hook(*other._first)._prev = _last;
+        } else _first = other._first;
+        _last = other._last;
+        _size += other._size;
+        other._first = other._last = nullptr;
+        other._size  = 0;
+    }
+
+    void swap(Intrusive_list& other) noexcept
+    {
+        std::swap(_first, other._first);
+        std::swap(_last,  other._last);
+        std::swap(_size,  other._size);
+    }
+
+    void move_to_front(T& t) noexcept
+    {
+        if (&t == _first) return;
+        erase(t);
+        push_front(t);
+    }
+};
+
+} // namespace helper
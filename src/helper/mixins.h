@@ -1,7 +1,10 @@
 #pragma once
 #include "../error.h"
+#include "../logger.h"
+#include "inplace_function.h"
+#include <array>
+#include <bitset>
 #include <concepts>
-#include <functional>
 
 #define HELPER_CONTAINER_WRAPPER(container) \
     inline bool empty()  const noexcept \
@@ -42,37 +45,107 @@ public:
     }
 };
 
-template <typename T, typename K = unsigned char>
+/**
+ * @brief Observers indexed by a small closed set of signals.
+ * Signals are marked dirty when they change, notify_all only fires dirty ones.
+ */
+template <typename T, typename K = unsigned char, std::size_t Signal_count = 8, std::size_t Max_observers = 4>
 class Observable
 {
 public:
     using Key                = K;
-    using Observer           = std::function<void(const T&)>;
-    using Observer_container = std::unordered_map<K, std::vector<Observer>>;
+    using Observer           = Inplace_function<void(const T&)>;
+
+    /**
+     * @brief Suppress notifications until the last guard goes out of scope,
+     * then fire each pending signal once.
+     */
+    class Batch final
+    {
+        const Observable& _observable;
+
+    public:
+        explicit Batch(const Observable& observable) noexcept
+            : _observable(observable)
+        { ++_observable._batch_depth; }
+
+        Batch(const Batch&)            = delete;
+        auto operator=(const Batch&)   = delete;
+
+        // Destructor can't throw, log what an observer throws instead of terminating.
+        ~Batch() noexcept
+        {
+            assert(_observable._batch_depth);
+            if (--_observable._batch_depth) return;
+            try {
+                _observable.notify_all();
+            } catch (const std::exception& err) {
+                logger::error("Observer failed at the end of batch -> {}", err.what());
+            }
+        }
+    };
 
 private:
-    Observer_container _observers;
+    struct _Slot
+    {
+        std::array<Observer, Max_observers> observers;
+        std::size_t                         size = 0;
+    };
+
+    std::array<_Slot, Signal_count> _slots;
+    // Every signal starts dirty, so the first notify_all fires everything.
+    mutable std::bitset<Signal_count> _dirty = std::bitset<Signal_count>().set();
+    mutable unsigned                  _batch_depth = 0;
+
+    static inline auto _index(const Key key) noexcept -> std::size_t
+    {
+        const auto index = static_cast<std::size_t>(key);
+        assert(index < Signal_count);
+        return index;
+    }
+
+    // Signal stays dirty until someone observes it.
+    inline void _fire(const std::size_t index) const
+    {
+        const _Slot& slot = _slots[index];
+        if (!slot.size) return;
+        _dirty.reset(index);
+        for (std::size_t i = 0; i < slot.size; ++i)
+            slot.observers[i](*static_cast<const T*>(this));
+    }
 
 public:
     template <typename Func>
-    inline void connect(Key&& key, Func&& func)
+    inline void connect(const Key key, Func&& func)
     {
-        _observers[std::forward<Key>(key)].emplace_back(std::forward<Func>(func));
+        _Slot& slot = _slots[_index(key)];
+        assert_runtime(slot.size < Max_observers, "Too many observers for signal");
+        slot.observers[slot.size++] = Observer(std::forward<Func>(func));
     }
 
-    inline void notify(Key&& key) const
+    inline auto batch() const noexcept -> Batch
+    { return Batch(*this); }
+
+    // Mark signal as changed without firing it.
+    inline void mark(const Key key) const noexcept
+    { _dirty.set(_index(key)); }
+
+    inline void mark_all() const noexcept
+    { _dirty.set(); }
+
+    inline void notify(const Key key) const
     {
-        const auto it = _observers.find(std::forward<Key>(key));
-        if (it != _observers.end())
-            for (const auto& o : it->second)
-                o(*static_cast<const T*>(this));
+        const auto index = _index(key);
+        if (_batch_depth) _dirty.set(index);
+        else              _fire(index);
     }
 
+    // Fire every dirty signal.
     inline void notify_all() const
     {
-        for (const auto& pair : _observers)
-            for (const auto& o : pair.second)
-                o(*static_cast<const T*>(this));
+        if (_batch_depth) return;
+        for (std::size_t i = 0; i < Signal_count; ++i)
+            if (_dirty.test(i)) _fire(i);
     }
 };
 
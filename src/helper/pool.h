@@ -0,0 +1,101 @@
+#pragma once
+#include "../error.h"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Class-specific allocation through helper::Object_pool.
+#define HELPER_POOL_ALLOCATED_DECLARE() \
+public: \
+    static auto operator new(std::size_t size) -> void*; \
+    static void operator delete(void* ptr) noexcept; \
+    static auto pool_stats() noexcept -> const helper::Pool_stats&; \
+
+#define HELPER_POOL_ALLOCATED_DEFINE(type) \
+    static auto _##type##_pool() noexcept -> helper::Object_pool<type>& \
+    { static helper::Object_pool<type> pool; return pool; } \
+    auto type::operator new([[maybe_unused]] std::size_t size) -> void* \
+    { assert(size == sizeof(type)); return _##type##_pool().allocate(); } \
+    void type::operator delete(void* ptr) noexcept \
+    { _##type##_pool().deallocate(ptr); } \
+    auto type::pool_stats() noexcept -> const helper::Pool_stats& \
+    { return _##type##_pool().stats(); } \
+
+namespace helper {
+
+struct Pool_stats
+{
+    // Total allocations served
+    std::size_t allocations = 0;
+    // Objects currently alive
+    std::size_t in_use      = 0;
+    // Highest in_use ever reached
+    std::size_t peak        = 0;
+    // Chunks of slots allocated from heap
+    std::size_t chunks      = 0;
+};
+
+/**
+ * @brief Fixed size object pool with a freelist.
+ * Memory is taken from heap in chunks and never returned until destruction.
+ * Not thread safe.
+ */
+template <std::size_t Size, std::size_t Align, std::size_t Chunk_size = 64>
+class Pool final
+{
+    union _Slot
+    {
+        _Slot* next;
+        alignas(Align) std::byte storage[Size];
+    };
+
+    std::vector<std::unique_ptr<_Slot[]>> _chunks;
+    _Slot*                                _free = nullptr;
+    Pool_stats                            _stats;
+
+    void _grow()
+    {
+        auto& chunk = _chunks.emplace_back(std::make_unique<_Slot[]>(Chunk_size));
+        for (std::size_t i = Chunk_size; i-- > 0;) {
+            chunk[i].next = _free;
+            _free = &chunk[i];
+        }
+        ++_stats.chunks;
+    }
+
+public:
+    Pool() noexcept = default;
+
+    Pool(const Pool&)              = delete;
+    Pool(Pool&&)                   = delete;
+    auto operator=(const Pool&)    = delete;
+    auto operator=(Pool&&)         = delete;
+
+    auto allocate() -> void*
+    {
+        if (!_free) _grow();
+        _Slot* slot = _free;
+        _free = slot->next;
+        ++_stats.allocations;
+        if (++_stats.in_use > _stats.peak) _stats.peak = _stats.in_use;
+        return slot->storage;
+    }
+
+    void deallocate(void* ptr) noexcept
+    {
+        if (!ptr) return;
+        assert(_stats.in_use);
+        auto* slot = static_cast<_Slot*>(ptr);
+        slot->next = _free;
+        _free = slot;
+        --_stats.in_use;
+    }
+
+    inline auto stats() const noexcept -> const Pool_stats&
+    { return _stats; }
+};
+
+template <typename T>
+using Object_pool = Pool<sizeof(T), alignof(T)>;
+
+} // namespace helper
@@ -0,0 +1,144 @@
+#pragma once
+#include "../error.h"
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace helper {
+
+/**
+ * @brief Generational reference into a Slot_map.
+ * Stale handle is detected by generation mismatch.
+ */
+template <typename Tag>
+struct Handle
+{
+    static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+    uint32_t index      = npos;
+    uint32_t generation = 0;
+
+    inline explicit operator bool() const noexcept
+    { return index != npos; }
+
+    friend bool operator==(const Handle&, const Handle&) noexcept = default;
+};
+
+/**
+ * @brief Values stored contiguously, addressed by generational handles.
+ * Erase swaps the last value into the hole, so iteration order isn't stable.
+ */
+template <typename T, typename Tag = T>
+class Slot_map
+{
+public:
+    using handle_type    = Handle<Tag>;
+    using container_type = std::vector<T>;
+    using iterator       = typename container_type::iterator;
+    using const_iterator = typename container_type::const_iterator;
+    using size_type      = typename container_type::size_type;
+
+private:
+    struct _Slot
+    {
+        // Index into dense values, or next free slot.
+        uint32_t index;
+        uint32_t generation;
+    };
+
+    container_type        _values;
+    std::vector<uint32_t> _value_slots;
+    std::vector<_Slot>    _slots;
+    uint32_t              _free_head = handle_type::npos;
+
+    inline auto _slot(const handle_type& handle) const noexcept -> const _Slot*
+    {
+        if (handle.index >= _slots.size()) return nullptr;
+        const _Slot& slot = _slots[handle.index];
+        return (slot.generation == handle.generation) ? &slot : nullptr;
+    }
+
+public:
+    inline bool empty() const noexcept
+    { return _values.empty(); }
+
+    inline auto size() const noexcept -> size_type
+    { return _values.size(); }
+
+    inline auto begin()        noexcept -> iterator
+    { return _values.begin(); }
+    inline auto end()          noexcept -> iterator
+    { return _values.end(); }
+    inline auto begin()  const noexcept -> const_iterator
+    { return _values.cbegin(); }
+    inline auto end()    const noexcept -> const_iterator
+    { return _values.cend(); }
+    inline auto cbegin() const noexcept -> const_iterator
+    { return _values.cbegin(); }
+    inline auto cend()   const noexcept -> const_iterator
+    { return _values.cend(); }
+
+    inline bool contains(const handle_type& handle) const noexcept
+    { return _slot(handle); }
+
+    inline auto get(const handle_type& handle) noexcept -> T*
+    {
+        const _Slot* slot = _slot(handle);
+        return (slot) ? &_values[slot->index] : nullptr;
+    }
+
+    inline auto get(const handle_type& handle) const noexcept -> const T*
+    {
+        const _Slot* slot = _slot(handle);
+        return (slot) ? &_values[slot->index] : nullptr;
+    }
+
+    auto insert(T value) -> handle_type
+    {
+        uint32_t slot_index = _free_head;
+        if (slot_index == handle_type::npos) {
+            slot_index = static_cast<uint32_t>(_slots.size());
+            _slots.push_back({0, 0});
+        } else {
+            _free_head = _slots[slot_index].index;
+        }
+        _Slot& slot = _slots[slot_index];
+        slot.index  = static_cast<uint32_t>(_values.size());
+        _values.push_back(std::move(value));
+        _value_slots.push_back(slot_index);
+        return {slot_index, slot.generation};
+    }
+
+    void erase(const handle_type& handle) noexcept
+    {
+        assert(contains(handle));
+        _Slot& slot = _slots[handle.index];
+        const uint32_t hole = slot.index;
+        // Fill the hole with the last value.
+        if (hole != _values.size() - 1) {
+            _values[hole]      = std::move(_values.back());
+            _value_slots[hole] = _value_slots.back();
+            _slots[_value_slots[hole]].index = hole;
+        }
+        _values.pop_back();
+        _value_slots.pop_back();
+        // Invalidate every handle to this slot.
+        ++slot.generation;
+        slot.index = _free_head;
+        _free_head = handle.index;
+    }
+
+    void clear() noexcept
+    {
+        for (const uint32_t slot_index : _value_slots) {
+            _Slot& slot = _slots[slot_index];
+            ++slot.generation;
+            slot.index = _free_head;
+            _free_head = slot_index;
+        }
+        _values.clear();
+        _value_slots.clear();
+    }
+};
+
+} // namespace helper
@@ -0,0 +1,118 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace helper {
+
+/**
+ * @brief Worker threads started once and reused for every run.
+ * Calling thread takes part in the work, jobs are handed out one index at a time.
+ * Only one thread may call run at a time.
+ */
+class Thread_pool
+{
+    using _Invoke_fn = void (*)(const void*, std::size_t) noexcept;
+
+    std::vector<std::jthread> _workers;
+    std::mutex                _mutex;
+    std::condition_variable   _start;
+    std::condition_variable   _finish;
+
+    // Current run, written under _mutex before workers are woken up.
+    _Invoke_fn         _invoke  = nullptr;
+    const void*        _job     = nullptr;
+    std::size_t        _count   = 0;
+    std::atomic_size_t _next    = 0;
+    std::size_t        _busy    = 0;
+    uint64_t           _run_id  = 0;
+    bool               _stopped = false;
+
+    void _drain() noexcept
+    {
+        for (auto i = _next++; i < _count; i = _next++)
+            _invoke(_job, i);
+    }
+
+    void _work() noexcept
+    {
+        uint64_t last_run = 0;
+        while (true) {
+            {
+                std::unique_lock lock(_mutex);
+                _start.wait(lock, [&] { return _stopped || _run_id != last_run; });
+                if (_stopped) return;
+                last_run = _run_id;
+            }
+            _drain();
+            std::lock_guard lock(_mutex);
+            if (--_busy == 0) _finish.notify_one();
+        }
+    }
+
+public:
+    /**
+     * @brief Start worker threads.
+     * @param worker_count Threads besides the calling one, zero runs everything inline
+     */
+    explicit Thread_pool(std::size_t worker_count)
+    {
+        _workers.reserve(worker_count);
+        for (std::size_t i = 0; i < worker_count; ++i)
+            _workers.emplace_back([this] { _work(); });
+    }
+
+    Thread_pool(const Thread_pool&)    = delete;
+    auto operator=(const Thread_pool&) = delete;
+
+    inline auto worker_count() const noexcept -> std::size_t
+    { return _workers.size(); }
+
+    /**
+     * @brief Call job(i) for every i below count, return once all are done.
+     * Jobs run concurrently, they must only share data they don't modify.
+     * @param count
+     * @param job Callable taking std::size_t, must not throw
+     */
+    template <typename Func>
+    void run(std::size_t count, const Func& job) noexcept
+    {
+        static_assert(std::is_nothrow_invocable_v<const Func&, std::size_t>, "Job must not throw");
+        if (_workers.empty() || count <= 1) {
+            for (std::size_t i = 0; i < count; ++i) job(i);
+            return;
+        }
+        {
+            std::lock_guard lock(_mutex);
+            _invoke = [](const void* f, std::size_t i) noexcept { (*static_cast<const Func*>(f))(i); };
+            _job    = std::addressof(job);
+            _count  = count;
+            _next   = 0;
+            _busy   = _workers.size();
+            ++_run_id;
+        }
+        _start.notify_all();
+        _drain();
+        // Job lives on the caller stack, wait until no worker can touch it.
+        std::unique_lock lock(_mutex);
+        _finish.wait(lock, [&] { return _busy == 0; });
+    }
+
+    ~Thread_pool() noexcept
+    {
+        {
+            std::lock_guard lock(_mutex);
+            _stopped = true;
+        }
+        _start.notify_all();
+        // Workers are joined by jthread.
+    }
+};
+
+} // namespace helper
@@ -1,7 +1,14 @@
 #include "layout.h"
+#include "config.h"
 #include "logger.h"
+#include "window.h"
+#include "workspace.h"
+
+#include <algorithm>
 #include "x86intrin.h"
 
+HELPER_POOL_ALLOCATED_DEFINE(Layout)
+
 static auto _reciprocal(float x) -> float
 {
 #if defined(__x86_64__) or defined(__i386__)
@@ -16,54 +23,125 @@ Layout::Layout(Containment_type type)
     : _type(type)
 {}
 
-static void _update_rect_horizontal(Layout& layout)
+// Layout children are either layouts or windows, both final.
+// Dispatch on node tag instead of going through vtable.
+static inline void _child_rect(Node<Container>& child, const Vector2D& rect) noexcept
 {
-    const auto& rect = layout.rect();
-    logger::debug("Hcon rect update -> x: {}, y: {}, width: {}, height: {}",
-                  rect.pos.x, rect.pos.y, rect.size.x, rect.size.y);
+    if (child.is_leaf()) static_cast<Window&>(child).rect<Window>(rect);
+    else static_cast<Layout&>(child).rect<Layout>(rect);
+}
 
-    int next_pos_x    = rect.pos.x;
-    const int f_width = std::round(_reciprocal((float)layout.size()) * (float)rect.size.x);
+// Visible means its workspace is shown and it's not behind another tab.
+static bool _is_shown(const Node<Container>& node)
+{
+    const Node<Container>* n = &node;
+    while (n->parent()) {
+        const auto& parent = n->parent_unsafe();
+        if (!parent.is_root()) {
+            const auto& layout = parent.get<Layout>();
+            if (layout.type() == Layout::Containment_type::Tabbed && layout.active() != *n)
+                return false;
+        }
+        n = &parent;
+    }
+    return n->is_root() && static_cast<const Workspace&>(*n).shown();
+}
+
+static void _hide_subtree(Node<Container>& node)
+{
+    if (node.is_leaf()) return node.get<Window>().minimize();
+    for (auto& child : node) _hide_subtree(child);
+}
+
+static void _show_subtree(Node<Container>& node)
+{
+    if (node.is_leaf()) return node.get<Window>().normalize();
+    const auto& layout = node.get<Layout>();
+    if (layout.type() == Layout::Containment_type::Tabbed) {
+        if (!layout.empty()) _show_subtree(layout.active());
+    } else {
+        for (auto& child : node) _show_subtree(child);
+    }
+}
+
+static auto _total_weight(const Layout& layout) -> float
+{
+    float total = 0;
+    for (const auto& child : layout) total += child.weight();
+    return total;
+}
+
+// Pure geometry of horizontal layout children, last child takes the rest,
+// so rounding leaves no hole.
+template <typename Func>
+static void _split_horizontal(const Layout& layout, const Vector2D& rect, Func&& func)
+{
+    int next_pos_x     = rect.pos.x;
+    const float unit_x = _reciprocal(_total_weight(layout)) * (float)rect.size.x;
     for (auto& child : layout) {
-        child.rect({
+        const int width = (child == layout.back())
+                        ? rect.pos.x + rect.size.x - next_pos_x
+                        : (int)std::round(unit_x * child.weight());
+        func(child, Vector2D{
             { next_pos_x, rect.pos.y  },
-            { f_width,    rect.size.y }
+            { width,      rect.size.y }
         });
-        next_pos_x += f_width;
+        next_pos_x += width;
     }
 }
 
-static void _update_rect_vertical(Layout& layout)
+template <typename Func>
+static void _split_vertical(const Layout& layout, const Vector2D& rect, Func&& func)
 {
-    const auto& rect = layout.rect();
-    logger::debug("Vcon rect update -> x: {}, y: {}, width: {}, height: {}",
-                  rect.pos.x, rect.pos.y, rect.size.x, rect.size.y);
-
     int next_pos_y     = rect.pos.y;
-    const int f_height = std::round(_reciprocal((float)layout.size()) * (float)rect.size.y);
+    const float unit_y = _reciprocal(_total_weight(layout)) * (float)rect.size.y;
     for (auto& child : layout) {
-        child.rect({
-            { rect.pos.x, next_pos_y },
-            { rect.size.x, f_height  }
+        const int height = (child == layout.back())
+                         ? rect.pos.y + rect.size.y - next_pos_y
+                         : (int)std::round(unit_y * child.weight());
+        func(child, Vector2D{
+            { rect.pos.x,  next_pos_y },
+            { rect.size.x, height     }
         });
-        next_pos_y += f_height;
+        next_pos_y += height;
     }
 }
 
+static void _update_rect_horizontal(Layout& layout)
+{
+    const auto& rect = layout.rect();
+    logger::debug("Hcon rect update -> x: {}, y: {}, width: {}, height: {}",
+                  rect.pos.x, rect.pos.y, rect.size.x, rect.size.y);
+    _split_horizontal(layout, rect, _child_rect);
+}
+
+static void _update_rect_vertical(Layout& layout)
+{
+    const auto& rect = layout.rect();
+    logger::debug("Vcon rect update -> x: {}, y: {}, width: {}, height: {}",
+                  rect.pos.x, rect.pos.y, rect.size.x, rect.size.y);
+    _split_vertical(layout, rect, _child_rect);
+}
+
 static void _update_rect_tabbed(Layout& layout)
 {
     const auto& rect = layout.rect();
     logger::debug("Tcon rect update -> x: {}, y: {}, width: {}, height: {}",
                   rect.pos.x, rect.pos.y, rect.size.x, rect.size.y);
 
-    // Reduce height by tab size
-    for (auto& child : layout) {
-        child.rect(rect);
-    }
+    // Only active tab is configured and mapped.
+    // Hidden tabs get their rect once activated.
+    auto& active = layout.active();
+    for (auto& child : layout)
+        if (child != active) _hide_subtree(child);
+    _child_rect(active, rect);
+    if (_is_shown(layout)) _show_subtree(active);
 }
 
 void Layout::_update_rect_fn() noexcept
 {
+    if (empty()) return;
+    _active = &active();
     switch(_type) {
     case Containment_type::Horizontal:
         return _update_rect_horizontal(*this);
@@ -81,7 +159,212 @@ void Layout::_update_focus_fn() noexcept
 {
 }
 
+void Layout::type(const Containment_type& type) noexcept
+{
+    const bool was_tabbed = (_type == Containment_type::Tabbed);
+    _type = type;
+    update_rect();
+    // Hidden tabs are no longer hidden.
+    if (was_tabbed && _type != Containment_type::Tabbed && _is_shown(*this))
+        for (auto& child : *this) _show_subtree(child);
+}
+
+auto Layout::active() const noexcept -> Node<Container>&
+{
+    assert(!empty());
+    for (auto& child : *this)
+        if (&child == _active) return child;
+    return front();
+}
+
+void Layout::activate(Node<Container>& child) noexcept
+{
+    assert(child.parent() && child.parent_unsafe() == *this);
+    auto& last = active();
+    _active = &child;
+    if (_type != Containment_type::Tabbed || last == child) return;
+
+    // Map the new tab before unmapping the last one.
+    _child_rect(child, rect());
+    if (_is_shown(*this)) _show_subtree(child);
+    _hide_subtree(last);
+}
+
+void Layout::resize(Node<Container>& child, Node<Container>& sibling, float delta) noexcept
+{
+    assert(child.parent() && child.parent_unsafe() == *this);
+    assert(sibling.parent() && sibling.parent_unsafe() == *this);
+    if (_type != Containment_type::Horizontal && _type != Containment_type::Vertical)
+        return;
+
+    const float total  = child.weight() + sibling.weight();
+    const float min    = total * config::MIN_RESIZE_RATIO;
+    const float weight = std::clamp(child.weight() + delta * total, min, total - min);
+    child.weight(weight);
+    sibling.weight(total - weight);
+
+    // Both children share the same span, split it again between them.
+    const bool horizontal = (_type == Containment_type::Horizontal);
+    auto& first  = (horizontal ? child.rect().pos.x < sibling.rect().pos.x
+                               : child.rect().pos.y < sibling.rect().pos.y) ? child : sibling;
+    auto& second = (first == child) ? sibling : child;
+    Vector2D first_rect  = first.rect();
+    Vector2D second_rect = second.rect();
+    if (horizontal) {
+        const int span = first_rect.size.x + second_rect.size.x;
+        first_rect.size.x  = std::round(span * first.weight() * _reciprocal(total));
+        second_rect.pos.x  = first_rect.pos.x + first_rect.size.x;
+        second_rect.size.x = span - first_rect.size.x;
+    } else {
+        const int span = first_rect.size.y + second_rect.size.y;
+        first_rect.size.y  = std::round(span * first.weight() * _reciprocal(total));
+        second_rect.pos.y  = first_rect.pos.y + first_rect.size.y;
+        second_rect.size.y = span - first_rect.size.y;
+    }
+    logger::debug("Layout resize -> weight: {}, sibling weight: {}", child.weight(), sibling.weight());
+    _child_rect(first, first_rect);
+    _child_rect(second, second_rect);
+}
+
 Layout::~Layout() noexcept
 {
-    for (const auto& child : *this) delete &child;
+    // Unlink before delete, iterating would read links of a deleted child.
+    while (!empty()) {
+        auto& child = front();
+        remove_child(child);
+        delete &child;
+    }
+}
+
+namespace layout {
+
+bool is_hidden(const Node<Container>& node) noexcept
+{
+    for (const Node<Container>* n = &node; n->parent() && !n->parent_unsafe().is_root(); n = &n->parent_unsafe()) {
+        const auto& layout = n->parent_unsafe().get<Layout>();
+        if (layout.type() == Layout::Containment_type::Tabbed && layout.active() != *n)
+            return true;
+    }
+    return false;
+}
+
+void reveal(Node<Container>& node) noexcept
+{
+    // Bottom up, so outer tab shows the already activated inner tab.
+    for (Node<Container>* n = &node; n->parent() && !n->parent_unsafe().is_root(); n = &n->parent_unsafe())
+        n->parent_unsafe().get<Layout>().activate(*n);
+}
+
+void compute_rects(const Node<Container>& node, const Vector2D& rect, Rect_list& rects)
+{
+    // Constness doesn't propagate to children, node is only written by apply_rects.
+    rects.emplace_back(const_cast<Node<Container>*>(&node), rect);
+    if (node.is_leaf() || node.empty()) return;
+
+    const auto& layout = node.get<Layout>();
+    const auto  child  = [&](const Node<Container>& c, const Vector2D& r) { compute_rects(c, r, rects); };
+    switch (layout.type()) {
+    case Layout::Containment_type::Horizontal:
+        return _split_horizontal(layout, rect, child);
+    case Layout::Containment_type::Vertical:
+        return _split_vertical(layout, rect, child);
+    case Layout::Containment_type::Tabbed:
+        return compute_rects(layout.active(), rect, rects);
+    case Layout::Containment_type::Floating:
+        return;
+    }
+}
+
+void apply_rects(const Rect_list& rects) noexcept
+{
+    // Active tabs show up once their subtree is configured, like the cascade does.
+    std::vector<Layout*> tabbed;
+    for (const auto& [node, rect] : rects) {
+        if (node->is_leaf()) {
+            static_cast<Window&>(*node).rect<Window>(rect);
+            continue;
+        }
+        node->assign_rect(rect);
+        if (node->is_root() || node->empty()) continue;
+
+        auto& layout = node->get<Layout>();
+        // Drops a stale active child, as the cascade does.
+        layout.activate(layout.active());
+        if (layout.type() != Layout::Containment_type::Tabbed) continue;
+        for (auto& child : layout)
+            if (child != layout.active()) _hide_subtree(child);
+        tabbed.push_back(&layout);
+    }
+    for (auto* layout : tabbed)
+        if (_is_shown(*layout)) _show_subtree(layout->active());
+}
+
+// Nested tabs are kept, they are not the same as one tab level.
+static bool _is_flattenable(const Node<Container>& node)
+{
+    if (node.is_leaf() || !node.parent() || node.parent_unsafe().is_root())
+        return false;
+    const auto type = node.get<Layout>().type();
+    return (type == Layout::Containment_type::Horizontal || type == Layout::Containment_type::Vertical)
+        && (type == node.parent_unsafe().get<Layout>().type());
+}
+
+// Move node children into its parent, in node position.
+// returns false if fails.
+static bool _flatten_node(Node<Container>& node)
+{
+    if (!_is_flattenable(node)) return false;
+    auto& parent = node.parent_unsafe();
+    const auto node_it = parent.iterator_to(node);
+
+    // Children keep their share of node weight.
+    float total = 0;
+    for (const auto& child : node) total += child.weight();
+    const float scale = node.weight() * _reciprocal(total);
+
+    while (!node.empty()) {
+        Node<Container>& child = node.front();
+        node.erase_child(node.begin());
+        child.weight(child.weight() * scale);
+        parent.insert_child(node_it, child);
+    }
+    parent.erase_child(node_it);
+    delete &node;
+    return true;
+}
+
+// returns false if fails.
+static bool _purge_sole_node(Node<Container>& node)
+{
+    assert(node.parent());
+    auto& parent = node.parent_unsafe();
+
+    // If node has one child, move its child into its parent.
+    if ((node.size() == 1) && (!node.back().is_leaf() || !parent.is_root())) {
+        Node<Container>& back = node.back();
+        node.erase_child(node.begin());
+        back.weight(node.weight());
+        const auto node_it = parent.iterator_to(node);
+        parent.insert_child(node_it, back);
+        parent.erase_child(node_it);
+        delete &node;
+        // Child might split the same way as its new parent.
+        _flatten_node(back);
+    } else return false;
+    return true;
+}
+
+auto compact(Node<Container>& node) -> Node<Container>&
+{
+    assert(!node.is_leaf() && !node.is_root());
+    auto& parent = node.parent_unsafe();
+
+    for (auto it = node.begin(); it != node.end();)
+        _flatten_node(*it++);
+
+    if (_purge_sole_node(node) || _flatten_node(node))
+        return parent;
+    return node;
 }
+
+} // namespace layout
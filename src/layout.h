@@ -1,11 +1,16 @@
 #pragma once
 #include "container.h"
 #include "node.h"
+#include "helper/pool.h"
+
+#include <utility>
+#include <vector>
 
 class Layout_frame;
 
-class Layout : public Node<Container>
+class Layout final : public Node<Container>
 {
+    friend class Container;
     void _update_rect_fn()  noexcept override;
     void _update_focus_fn() noexcept override;
 
@@ -20,20 +25,43 @@ public:
 
 private:
     Containment_type _type;
+    // Child shown in tabbed layout, kept for other types too.
+    Node<Container>* _active{};
 
 public:
     inline auto type() const noexcept -> Containment_type
     { return _type; }
 
-    inline void type(const Containment_type& type) noexcept
-    {
-        _type = type;
-        update_rect();
-    }
+    void type(const Containment_type& type) noexcept;
 
 public:
     explicit Layout(Containment_type type);
 
+    /**
+     * @brief Get active child.
+     * Falls back to the front child if active child is no longer a child.
+     * @return Reference to active child
+     */
+    auto active() const noexcept -> Node<Container>&;
+
+    /**
+     * @brief Set active child.
+     * On tabbed layout, only active child is mapped.
+     * @param child
+     */
+    void activate(Node<Container>& child) noexcept;
+
+    /**
+     * @brief Move weight from sibling to child.
+     * Only both children are reconfigured, the rest stays untouched.
+     * @param child
+     * @param sibling Child adjacent to child
+     * @param delta Weight to move, in fraction of both weights
+     */
+    void resize(Node<Container>& child, Node<Container>& sibling, float delta) noexcept;
+
+    HELPER_POOL_ALLOCATED_DECLARE()
+
     ~Layout() noexcept override;
 };
 
@@ -50,4 +78,50 @@ inline constexpr auto layout_type_to_str(Layout::Containment_type type) -> std::
         return "Floating";
     }
     return "bruh";
-}
\ No newline at end of file
+}
+
+namespace layout {
+
+// Precomputed rects, parents come before their children.
+using Rect_list = std::vector<std::pair<Node<Container>*, Vector2D>>;
+
+/**
+ * @brief Check if node is hidden behind another tab.
+ * @param node
+ */
+bool is_hidden(const Node<Container>& node) noexcept;
+
+/**
+ * @brief Activate every layout from node up to its root.
+ * Makes node visible if it's inside tabbed layout.
+ * @param node
+ */
+void reveal(Node<Container>& node) noexcept;
+
+/**
+ * @brief Compute rects the cascade would give to node and its subtree.
+ * Only reads the tree, disjoint subtrees can be computed concurrently.
+ * Hidden tabs are skipped, they get their rect once activated.
+ * @param node
+ * @param rect Rect of node
+ * @param rects Output, node itself first
+ */
+void compute_rects(const Node<Container>& node, const Vector2D& rect, Rect_list& rects);
+
+/**
+ * @brief Apply rects from compute_rects, as the cascade would.
+ * Windows are configured and tabs hidden or shown, call from the main thread.
+ * @param rects
+ */
+void apply_rects(const Rect_list& rects) noexcept;
+
+/**
+ * @brief Remove levels around layout node that don't change geometry.
+ * Collapses node if it only has one child, and flattens layouts
+ * splitting the same way as their parent.
+ * @param node Layout node
+ * @return Reference to the node whose rect needs to be updated
+ */
+auto compact(Node<Container>& node) -> Node<Container>&;
+
+} // namespace layout
\ No newline at end of file
@@ -12,16 +12,18 @@
 
 static bool _parse_arguments(int argc, char* const argv[])
 {
-    static constexpr std::array<option, 3> options{{
+    static constexpr std::array<option, 5> options{{
          {"help", no_argument, 0, 'h'},
          {"replace", no_argument, 0, 'r'},
          {"use-xinerama", no_argument, 0, 'x'},
+         {"hide-offscreen", no_argument, 0, 'o'},
+         {0, 0, 0, 0},
     }};
 
     int opt_index = 0;
     int opt = 0;
 
-    while ((opt = getopt_long(argc, argv, "hrx",
+    while ((opt = getopt_long(argc, argv, "hrxo",
                               options.data(), &opt_index))
             != -1) {
         switch (opt) {
@@ -34,6 +36,9 @@ static bool _parse_arguments(int argc, char* const argv[])
         case 'x':
             config::enable_xinerama = true;
             break;
+        case 'o':
+            config::hide_mode = config::Hide_mode::Offscreen;
+            break;
         default:
             logger::error("Unrecognized options");
             return false;
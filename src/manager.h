@@ -4,24 +4,38 @@
  * To manage containers.
  */
 #include "managed.h"
+#include "helper/flat_map.h"
 #include "helper/mixins.h"
+#include "helper/slot_map.h"
 #include "helper/std_extension.h"
 #include <concepts>
-#include <unordered_map>
+#include <utility>
 
 class Connection;
 
+// Not constrained by requires, so Manager<T>& can be named while T is incomplete.
 template <typename Type>
-requires (std::is_base_of<Managed<typename Type::Index>, Type>::value)
 class Manager : public helper::Init_once<Manager<Type>>
               , public helper::Observable<Manager<Type>>
 {
+    static_assert(std::is_base_of<Managed<typename Type::Index>, Type>::value);
+
 public:
     using Key                = typename Type::Index;
-    using Managed_container  = std::unordered_map<Key, Type*>;
+    using Handle             = helper::Handle<Type>;
+    using Managed_container  = helper::Slot_map<std::pair<Key, Type*>, Type>;
 
 private:
-    Managed_container _managed;
+    // Dense storage, iterated in insertion order until something is erased.
+    Managed_container                 _managed;
+    // Key lookup, pointer is kept alongside handle so a hit is a single probe.
+    helper::Flat_map<Key, std::pair<Handle, Type*>> _index;
+
+    inline auto _find(const Key& key) const noexcept -> Type*
+    {
+        const auto* entry = _index.find(key);
+        return (entry) ? entry->second : nullptr;
+    }
 
 public:
     Manager() noexcept = default;
@@ -33,13 +47,48 @@ public:
 
 public:
     inline auto at(const Key& key) const -> Type&
-    { return *_managed.at(key); }
+    {
+        Type* managed = _find(key);
+        assert_runtime<Existence_error>(managed, "Accessing unmanaged item");
+        return *managed;
+    }
 
     inline auto operator[](const Key& key) const noexcept -> std::optref<Type>
-    { return _managed.contains(key) ? std::optref<Type>(*_managed.at(key)) : std::nullopt; }
+    {
+        Type* managed = _find(key);
+        return (managed) ? std::optref<Type>(*managed) : std::nullopt;
+    }
 
     inline bool contains(const Key& key) const noexcept
-    { return _managed.contains(key); }
+    { return _index.contains(key); }
+
+    /**
+     * @brief Get handle of managed item, stays valid until it's unmanaged.
+     * @param key
+     * @return Invalid handle if key isn't managed
+     */
+    inline auto handle(const Key& key) const noexcept -> Handle
+    {
+        const auto* entry = _index.find(key);
+        return (entry) ? entry->first : Handle{};
+    }
+
+    inline bool valid(const Handle& handle) const noexcept
+    { return _managed.contains(handle); }
+
+    inline auto get(const Handle& handle) const noexcept -> std::optref<Type>
+    {
+        const auto* pair = _managed.get(handle);
+        return (pair) ? std::optref<Type>(*pair->second) : std::nullopt;
+    }
+
+    // Stale handle is a bug, not a miss.
+    inline auto at(const Handle& handle) const -> Type&
+    {
+        const auto* pair = _managed.get(handle);
+        assert_runtime<Existence_error>(pair, "Accessing item by stale handle");
+        return *pair->second;
+    }
 
     HELPER_CONTAINER_WRAPPER(_managed)
 
@@ -48,18 +97,23 @@ public:
     requires (std::constructible_from<Derived, Key, Args...>)
     auto manage(const Key& key, Args&&... args) -> Derived&
     {
-        assert_runtime<Existence_error>(!_managed.contains(key), "Managing already managed key");
-        const auto& [it, _] = _managed.emplace(key, new Derived(key, std::forward<Args>(args)...));
-        assert(_);
+        assert_runtime<Existence_error>(!_index.contains(key), "Managing already managed key");
+        auto* managed = new Derived(key, std::forward<Args>(args)...);
+        _index.emplace(key, {_managed.insert({key, managed}), managed});
+        this->mark_all();
         this->notify_all();
-        return *static_cast<Derived*>(it->second);
+        return *managed;
     }
 
     void unmanage(const Key& key)
     {
-        assert_runtime<Existence_error>(_managed.contains(key), "Unmanaging unmanaged item");
-        delete _managed.at(key);
-        _managed.erase(key);
+        const auto* entry = _index.find(key);
+        assert_runtime<Existence_error>(entry, "Unmanaging unmanaged item");
+        const auto [handle, managed] = *entry;
+        delete managed;
+        _managed.erase(handle);
+        _index.erase(key);
+        this->mark_all();
         this->notify_all();
     }
 
@@ -68,6 +122,8 @@ public:
         for (const auto& [_, m] : _managed)
             delete m;
         _managed.clear();
+        _index.clear();
+        this->mark_all();
         this->notify_all();
     }
 };
@@ -1,40 +1,194 @@
 #include "monitor.h"
+#include "layout.h"
 #include "logger.h"
+#include "window.h"
 #include "workspace.h"
 
+#include "helper/thread_pool.h"
+
+#include <algorithm>
+#include <thread>
+
 void Monitor::_update_rect_fn() noexcept
 {
-    const auto& rect = this->rect();
+    const auto rect = workarea();
     logger::debug("Monitor rect update -> x: {}, y: {}, width: {}, height: {}",
                   rect.pos.x, rect.pos.y, rect.size.x, rect.size.y);
-    // Should count for dockarea rect
     for (auto& ws : *this)
-        ws.rect(rect);
+        ws.rect<Workspace>(rect);
 }
 
 void Monitor::_update_focus_fn() noexcept
 {
     if (focused()) {
-        if (_current) _current->focus();
+        if (_current) _workspace_mgr.at(_current).focus();
     } else {
-        if (_current) _current->unfocus();
+        if (_current) _workspace_mgr.at(_current).unfocus();
     }
 }
 
+void Monitor::current(const Workspace& workspace)
+{
+    const auto handle = _workspace_mgr.handle(workspace.index());
+    assert(std::ranges::contains(_workspaces, handle));
+    if (handle == _current) return;
+
+    if (_current)
+        for (auto& window : _workspace_mgr.at(_current).windows()) _spatial_index.remove(window);
+    _current = handle;
+    for (auto& window : workspace.windows()) _spatial_index.insert(window);
+}
+
 void Monitor::add_child(Workspace& workspace)
 {
-    workspace._monitor = this;
-    _workspaces.push_back(&workspace);
+    const auto handle = _workspace_mgr.handle(workspace.index());
+    assert(handle && !std::ranges::contains(_workspaces, handle));
+    workspace._monitor = workspace._monitor_mgr.handle(index());
+    _workspaces.push_back(handle);
+    // First workspace is shown right away.
+    if (!_current) current(workspace);
 }
 
-void Monitor::remove_child(Monitor::const_iterator it)
+void Monitor::remove_child(Workspace& workspace)
 {
-    assert(std::ranges::contains(_workspaces, &*it));
-    it->_monitor = nullptr;
+    const auto it = std::ranges::find(_workspaces, _workspace_mgr.handle(workspace.index()));
+    assert(it != _workspaces.end());
+    const bool shown = (_current == *it);
+    if (shown) {
+        for (auto& window : workspace.windows()) _spatial_index.remove(window);
+        _current = {};
+    }
+    workspace._monitor = {};
     _workspaces.erase(it);
+    // Don't leave current stale, the last workspace is shown instead.
+    if (shown && !empty()) current(_workspace_mgr.at(_workspaces.back()));
+}
+
+auto Monitor::workarea() const noexcept -> Vector2D
+{
+    const auto& rect = this->rect();
+    return {
+        { rect.pos.x + _reserved.left, rect.pos.y + _reserved.top },
+        { std::max(0, rect.size.x - _reserved.left - _reserved.right),
+          std::max(0, rect.size.y - _reserved.top - _reserved.bottom) }
+    };
+}
+
+void Monitor::_reserve(const Strut& reserved) noexcept
+{
+    if (reserved == _reserved) return;
+    _reserved = reserved;
+    update_rect();
+}
+
+// Docks stack from the edge, so the widest one wins.
+static auto _widest(const Strut& lhs, const Strut& rhs) noexcept -> Strut
+{
+    return {
+        std::max(lhs.left,   rhs.left),
+        std::max(lhs.right,  rhs.right),
+        std::max(lhs.top,    rhs.top),
+        std::max(lhs.bottom, rhs.bottom),
+    };
+}
+
+bool Monitor::has_dock(const uint32_t dock_id) const noexcept
+{
+    return std::ranges::contains(_docks, dock_id, &std::pair<uint32_t, Strut>::first);
+}
+
+void Monitor::add_dock(const uint32_t dock_id, const Strut& strut)
+{
+    assert(!has_dock(dock_id));
+    _docks.emplace_back(dock_id, strut);
+    _reserve(_widest(_reserved, strut));
+}
+
+bool Monitor::update_dock(const uint32_t dock_id, const Strut& strut) noexcept
+{
+    const auto it = std::ranges::find(_docks, dock_id, &std::pair<uint32_t, Strut>::first);
+    assert(it != _docks.end());
+    if (it->second == strut) return false;
+    it->second = strut;
+
+    Strut reserved;
+    for (const auto& [_, s] : _docks) reserved = _widest(reserved, s);
+    _reserve(reserved);
+    return true;
 }
 
-Monitor::~Monitor() noexcept
+void Monitor::remove_dock(const uint32_t dock_id) noexcept
 {
-    { for (const auto& ws : _workspaces) delete ws; }
+    const auto it = std::ranges::find(_docks, dock_id, &std::pair<uint32_t, Strut>::first);
+    assert(it != _docks.end());
+    _docks.erase(it);
+
+    Strut reserved;
+    for (const auto& [_, s] : _docks) reserved = _widest(reserved, s);
+    _reserve(reserved);
 }
+
+// Workspaces are deleted by their manager.
+Monitor::~Monitor() noexcept = default;
+
+namespace monitor {
+
+// Only reads the tree, safe to run concurrently with other monitors.
+static void _compute_rects(const Monitor& monitor, layout::Rect_list& rects)
+{
+    const auto rect = monitor.workarea();
+    for (auto& ws : monitor) {
+        rects.emplace_back(&ws, rect);
+        const auto lrect = workspace::layout_rect(rect);
+        for (const auto& lcon : ws)
+            layout::compute_rects(lcon, lrect, rects);
+    }
+}
+
+void update_rect_all(const Manager<Monitor>& monitors) noexcept
+{
+    // Started on first use and kept, a few threads are plenty for a video wall.
+    static helper::Thread_pool pool(std::clamp(std::thread::hardware_concurrency(), 1u, 4u) - 1);
+
+    std::vector<const Monitor*> list;
+    list.reserve(monitors.size());
+    for (const auto& [_, monitor] : monitors)
+        list.push_back(monitor);
+
+    // Kept between calls, so relayout doesn't allocate once warmed up.
+    static std::vector<layout::Rect_list> results;
+    if (results.size() < list.size()) results.resize(list.size());
+    for (auto& rects : results) rects.clear();
+
+    pool.run(list.size(), [&](std::size_t i) noexcept { _compute_rects(*list[i], results[i]); });
+    logger::debug("Monitor rect update all -> monitors: {}, workers: {}", list.size(), pool.worker_count());
+
+    // X requests and tree writes only happen on this thread.
+    for (std::size_t i = 0; i < list.size(); ++i)
+        layout::apply_rects(results[i]);
+}
+
+auto find_dock(const Manager<Monitor>& monitors, const uint32_t dock_id) noexcept -> std::optref<Monitor>
+{
+    for (const auto& [_, monitor] : monitors)
+        if (monitor->has_dock(dock_id)) return *monitor;
+    return std::nullopt;
+}
+
+auto find_adjacent(const Manager<Monitor>& monitors, const Monitor& from, const Direction dir) noexcept
+    -> std::optref<Monitor>
+{
+    Spatial_index::Hit best;
+    Monitor* found = nullptr;
+    for (const auto& [_, monitor] : monitors) {
+        if (*monitor == from || monitor->empty()) continue;
+        const auto hit = spatial_index::rank(from.rect(), monitor->rect(), dir);
+        if (hit && hit->better_than(best)) {
+            best  = *hit;
+            found = monitor;
+        }
+    }
+    return (found) ? std::optref<Monitor>(*found) : std::nullopt;
+}
+
+} // namespace monitor
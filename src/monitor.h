@@ -1,28 +1,92 @@
 #pragma once
 #include "managed.h"
 #include "container.h"
+#include "manager.h"
+#include "spatial_index.h"
+#include "workspace.h"
 
-#include "helper/pointer_wrapper.h"
 #include "helper/std_extension.h"
 
+#include <iterator>
 #include <utility>
 #include <vector>
 #include <ranges>
 
-class Workspace;
-
 class Monitor final : public Container
                     , public Managed<uint32_t>
 {
-    std::string             _name;
-    Workspace*              _current;
-    std::vector<Workspace*> _workspaces;
+    using Workspace_handle = Manager<Workspace>::Handle;
+
+    std::string                   _name;
+    // Workspaces are owned by their manager, monitor refers to them by handle.
+    const Manager<Workspace>&     _workspace_mgr;
+    // Shown workspace, unset only while there's none.
+    Workspace_handle              _current;
+    std::vector<Workspace_handle> _workspaces;
+    // Windows of the shown workspace.
+    Spatial_index                 _spatial_index;
+    // Docks on this monitor by window id, and the largest strut per edge.
+    std::vector<std::pair<uint32_t, Strut>> _docks;
+    Strut                                   _reserved;
 
+    friend class Container;
+    friend class Workspace;
     void _update_rect_fn()  noexcept override;
     void _update_focus_fn() noexcept override;
+    // Lay out again if reserved space changed.
+    void _reserve(const Strut& reserved) noexcept;
 
 public:
-    HELPER_POINTER_ITERATOR_WRAPPER(_workspaces);
+    /**
+     * @brief Iterator over workspaces, resolving their handles.
+     * Stale handle throws, like Manager::at.
+     */
+    class iterator final
+    {
+        const Manager<Workspace>*                     _manager = nullptr;
+        std::vector<Workspace_handle>::const_iterator _iter;
+
+    public:
+        using difference_type   = std::ptrdiff_t;
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type        = Workspace;
+        using pointer           = Workspace*;
+        using reference         = Workspace&;
+
+        iterator() noexcept = default;
+        iterator(const Manager<Workspace>& manager,
+                 std::vector<Workspace_handle>::const_iterator iter) noexcept
+            : _manager(&manager)
+            , _iter(iter)
+        {}
+
+        auto operator*()     const -> reference
+        { return _manager->at(*_iter); }
+        auto operator->()    const -> pointer
+        { return &_manager->at(*_iter); }
+        auto operator++()    noexcept -> iterator&
+        { ++_iter; return *this; }
+        auto operator++(int) noexcept -> iterator
+        { auto it = *this; ++*this; return it; }
+        auto operator--()    noexcept -> iterator&
+        { --_iter; return *this; }
+        auto operator--(int) noexcept -> iterator
+        { auto it = *this; --*this; return it; }
+
+        friend bool operator==(const iterator& rhs, const iterator& lhs) noexcept
+        { return rhs._iter == lhs._iter; }
+    };
+    // Workspaces are not owned, constness doesn't propagate to them.
+    using const_iterator = iterator;
+
+    inline auto begin()  const noexcept -> iterator
+    { return iterator(_workspace_mgr, _workspaces.cbegin()); }
+    inline auto end()    const noexcept -> iterator
+    { return iterator(_workspace_mgr, _workspaces.cend()); }
+    inline auto cbegin() const noexcept -> const_iterator
+    { return begin(); }
+    inline auto cend()   const noexcept -> const_iterator
+    { return end(); }
 
     inline auto size() const noexcept -> std::size_t
     { return _workspaces.size(); }
@@ -33,33 +97,97 @@ public:
     inline auto name() const noexcept -> std::string_view
     { return _name; }
 
-    inline void current(const_iterator it)
-    {
-        assert(std::ranges::contains(_workspaces, &*it));
-        _current = &*it;
-    }
+    /**
+     * @brief Show a workspace on this monitor, its windows replace the last ones in the index.
+     * Windows aren't mapped or unmapped here.
+     * @param workspace
+     */
+    void current(const Workspace& workspace);
 
-    inline auto current() const noexcept -> const Workspace&
+    inline auto current() const -> const Workspace&
     {
-        assert(!empty());
-        return (_current) ? *_current : *_workspaces.back();
+        assert(_current);
+        return _workspace_mgr.at(_current);
     }
 
-    inline auto current() noexcept -> Workspace&
+    inline auto current() -> Workspace&
     {
-        assert(!empty());
-        return (_current) ? *_current : *_workspaces.back();
+        assert(_current);
+        return _workspace_mgr.at(_current);
     }
 
+    inline auto spatial_index() const noexcept -> const Spatial_index&
+    { return _spatial_index; }
+
+    /**
+     * @brief Monitor rect minus the space reserved by docks.
+     * Workspaces are laid out inside it.
+     */
+    auto workarea() const noexcept -> Vector2D;
+
+    bool has_dock(uint32_t dock_id) const noexcept;
+
+    /**
+     * @brief Reserve space for a dock, lay out again if the workarea shrinks.
+     * @param dock_id
+     * @param strut
+     */
+    void add_dock(uint32_t dock_id, const Strut& strut);
+
+    /**
+     * @brief Change space reserved by a dock, lay out again if the workarea changes.
+     * @param dock_id
+     * @param strut
+     * @return false if strut is the same
+     */
+    bool update_dock(uint32_t dock_id, const Strut& strut) noexcept;
+
+    /**
+     * @brief Release space of a dock, lay out again if the workarea grows.
+     * @param dock_id
+     */
+    void remove_dock(uint32_t dock_id) noexcept;
+
 public:
-     Monitor(const Index id, std::string name) noexcept
+     Monitor(const Index id, std::string name, const Manager<Workspace>& workspaces) noexcept
         : Managed(id)
         , _name(std::move(name))
-        , _current(nullptr)
+        , _workspace_mgr(workspaces)
      {}
 
     void add_child(Workspace& workspace);
-    void remove_child(const_iterator it);
+    void remove_child(Workspace& workspace);
 
     ~Monitor() noexcept override;
 };
+
+namespace monitor {
+
+/**
+ * @brief Lay out all monitors again, after a screen or gap change.
+ * Rects are computed per monitor on worker threads, then applied here in order.
+ * Monitor rects must be set already, with assign_rect to skip the serial cascade.
+ * @param monitors
+ */
+void update_rect_all(const Manager<Monitor>& monitors) noexcept;
+
+/**
+ * @brief Find the monitor a dock reserves space of.
+ * @param monitors
+ * @param dock_id
+ * @return std::nullopt if dock isn't on any monitor
+ */
+auto find_dock(const Manager<Monitor>& monitors, uint32_t dock_id) noexcept -> std::optref<Monitor>;
+
+/**
+ * @brief Find the nearest monitor in a direction, ranked like windows are.
+ * Monitors without workspace are skipped.
+ * @param monitors
+ * @param from
+ * @param dir
+ * @return std::nullopt if there's no monitor that way
+ */
+auto find_adjacent(const Manager<Monitor>& monitors, const Monitor& from, Direction dir) noexcept
+    -> std::optref<Monitor>;
+
+} // namespace monitor
@@ -1,19 +1,61 @@
 #pragma once
 #include "error.h"
-#include "helper/pointer_wrapper.h"
 #include "helper/std_extension.h"
-#include <list>
+#include <iterator>
 
 
 template <typename T>
 class Node;
 
+/**
+ * @brief Iterator over intrusive sibling links of Node.
+ * End iterator keeps the parent, so it can be decremented.
+ */
+template <typename T>
+class Node_iterator final
+{
+    Node<T>*       _node   = nullptr;
+    const Node<T>* _parent = nullptr;
+
+public:
+    using difference_type   = std::ptrdiff_t;
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type        = Node<T>;
+    using pointer           = Node<T>*;
+    using reference         = Node<T>&;
+
+    Node_iterator() noexcept = default;
+    Node_iterator(Node<T>* node, const Node<T>* parent) noexcept
+        : _node(node)
+        , _parent(parent)
+    {}
+
+    auto operator*()     const noexcept -> reference
+    { return *_node; }
+    auto operator->()    const noexcept -> pointer
+    { return _node; }
+    auto operator++()    noexcept -> Node_iterator&
+    { _node = _node->_next; return *this; }
+    auto operator++(int) noexcept -> Node_iterator
+    { auto it = *this; ++*this; return it; }
+    auto operator--()    noexcept -> Node_iterator&
+    { _node = (_node) ? _node->_prev : _parent->_last; return *this; }
+    auto operator--(int) noexcept -> Node_iterator
+    { auto it = *this; --*this; return it; }
+
+    friend bool operator==(const Node_iterator& rhs, const Node_iterator& lhs) noexcept
+    { return rhs._node == lhs._node; }
+};
+
 template <typename T>
 class Root : public Node<T>
 {
 public:
     Root() : Node<T>()
-    { this->_is_root = true; }
+    {
+        this->_is_root = true;
+        this->_root    = this;
+    }
 };
 
 template <typename T>
@@ -27,32 +69,101 @@ public:
 template <typename T>
 class Node : public T
 {
-    Node<T>*            _parent;
-    std::list<Node<T>*> _children;
+    friend class Node_iterator<T>;
+
+    Node<T>*    _parent = nullptr;
+    // Intrusive sibling links
+    Node<T>*    _prev   = nullptr;
+    Node<T>*    _next   = nullptr;
+    // Intrusive children links
+    Node<T>*    _first  = nullptr;
+    Node<T>*    _last   = nullptr;
+    std::size_t _size   = 0;
+
+    // Link node before position, nullptr means at the back.
+    void _link(Node<T>* position, Node<T>& node) noexcept
+    {
+        assert(!node._parent && !node._prev && !node._next);
+        assert(!position || position->_parent == this);
+        node._parent = this;
+        node._next   = position;
+        node._prev   = (position) ? position->_prev : _last;
+        (node._prev) ? node._prev->_next = &node : _first = &node;
+        (node._next) ? node._next->_prev = &node : _last  = &node;
+        ++_size;
+        _set_root(node, _root);
+    }
+
+    // Subtree shares the same cached root, stop where it already matches.
+    static void _set_root(Node<T>& node, Node<T>* root) noexcept
+    {
+        if (node._root == root) return;
+        node._root = root;
+        for (auto& child : node) _set_root(child, root);
+    }
+
+    // Unlinked subtree keeps its stale root, it's refreshed when linked again.
+    void _unlink(Node<T>& node) noexcept
+    {
+        assert(node._parent == this);
+        (node._prev) ? node._prev->_next = node._next : _first = node._next;
+        (node._next) ? node._next->_prev = node._prev : _last  = node._prev;
+        node._parent = node._prev = node._next = nullptr;
+        --_size;
+    }
+
+    template <typename U>
+    friend const Root<U>& get_root(const Node<U>& node);
+    template <typename U>
+    friend Root<U>& get_root(Node<U>& node);
 
 protected:
+    // Cached root of the tree, nullptr if never attached to one.
+    Node<T>* _root = nullptr;
+
     // object modifiers
     bool _is_root = false;
     bool _is_leaf = false;
 public:
-    HELPER_POINTER_ITERATOR_WRAPPER(_children)
+    // Children are not owned, constness doesn't propagate to them.
+    using iterator       = Node_iterator<T>;
+    using const_iterator = Node_iterator<T>;
+
+    inline auto begin() const noexcept -> iterator
+    { return iterator(_first, this); }
+
+    inline auto end()   const noexcept -> iterator
+    { return iterator(nullptr, this); }
+
+    inline auto cbegin() const noexcept -> const_iterator
+    { return begin(); }
+
+    inline auto cend()   const noexcept -> const_iterator
+    { return end(); }
+
+    // Iterator to child in O(1).
+    inline auto iterator_to(const Node<T>& child) const noexcept -> iterator
+    {
+        assert(child._parent == this);
+        return iterator(const_cast<Node<T>*>(&child), this);
+    }
 
     inline bool empty() const noexcept
-    { return _children.empty(); }
+    { return !_first; }
 
-    inline auto size() const noexcept -> std::list<Node<T>*>::size_type
-    { return _children.size(); }
+    inline auto size() const noexcept -> std::size_t
+    { return _size; }
 
     inline auto front() const noexcept -> Node<T>&
     {
-        assert(_children.front());
-        return *_children.front();
+        assert(_first);
+        return *_first;
     }
 
     inline auto back() const noexcept -> Node<T>&
     {
-        assert(_children.back());
-        return *_children.back();
+        assert(_last);
+        return *_last;
     }
 
     inline auto parent() const noexcept -> std::optref<Node<T>>
@@ -112,63 +223,67 @@ public:
         assert(!_is_leaf);
         assert(!node._is_root);
         assert(!(_is_root && node._is_leaf));
-        node._parent = this;
-        _children.push_back(&node);
+        _link(nullptr, node);
     }
 
     void remove_child(Node<T>& node)
-    {
-        auto node_it = std::ranges::find(_children, &node);
-        assert(node_it != _children.end());
-        (*node_it)->_parent = nullptr;
-        _children.erase(node_it);
-    }
+    { _unlink(node); }
 
     void erase_child(const_iterator node_it)
-    {
-        node_it->_parent = nullptr;
-        _children.erase(node_it);
-    }
+    { _unlink(*node_it); }
 
     void insert_child(const_iterator position, Node<T>& node)
     {
         assert(!_is_leaf);
         assert(!node._is_root);
         assert(!(_is_root && node._is_leaf));
-        node._parent = this;
-        _children.insert(position, &node);
+        _link((position == end()) ? nullptr : &*position, node);
     }
 
     void clear()
-    { _children.clear(); }
+    { while (_first) _unlink(*_first); }
 
     void shift_child_forward(const_iterator position)
     {
-        _children.splice(std::ranges::next(position, 2), _children, position);
+        Node<T>& node = *position;
+        assert(node._next);
+        Node<T>* after = node._next->_next;
+        _unlink(node);
+        _link(after, node);
     }
 
     void shift_child_backward(const_iterator position)
     {
-        _children.splice(std::ranges::prev(position), _children, position);
+        Node<T>& node = *position;
+        assert(node._prev);
+        Node<T>* before = node._prev;
+        _unlink(node);
+        _link(before, node);
     }
 };
 
+#ifndef NDEBUG
 template <typename T>
-inline const Root<T>& get_root(const Node<T>& node)
+inline bool is_cached_root_valid(const Node<T>& node, const Node<T>* root)
 {
     const Node<T>* n = &node;
-    while (n->parent()) n = &n->parent()->get();
-    assert(n->is_root());
-    return *n;
+    while (n->parent()) n = &n->parent_unsafe();
+    return n->is_root() && n == root;
+}
+#endif
+
+template <typename T>
+inline const Root<T>& get_root(const Node<T>& node)
+{
+    assert_debug(is_cached_root_valid(node, node._root), "Cached root is out of date");
+    return static_cast<const Root<T>&>(*node._root);
 }
 
 template <typename T>
 inline Root<T>& get_root(Node<T>& node)
 {
-    Node<T>* n = &node;
-    while (n->parent()) n = &n->parent()->get();
-    assert(n->is_root());
-    return static_cast<Root<T>&>(*n);
+    assert_debug(is_cached_root_valid(node, node._root), "Cached root is out of date");
+    return static_cast<Root<T>&>(*node._root);
 }
 
 template <typename T>
@@ -187,6 +302,27 @@ inline Leaf<T>& get_back_leaf(Node<T>& node)
     return static_cast<Leaf<T>&>(*leaf);
 }
 
+template <typename T>
+inline Node<T>& get_common_ancestor(Node<T>& lhs, Node<T>& rhs)
+{
+    const auto depth = [](const Node<T>* n) {
+        std::size_t d = 0;
+        for (; n->parent(); ++d) n = &n->parent_unsafe();
+        return d;
+    };
+    Node<T>* l = &lhs;
+    Node<T>* r = &rhs;
+    std::size_t l_depth = depth(l);
+    std::size_t r_depth = depth(r);
+    for (; l_depth > r_depth; --l_depth) l = &l->parent_unsafe();
+    for (; r_depth > l_depth; --r_depth) r = &r->parent_unsafe();
+    while (l != r) {
+        l = &l->parent_unsafe();
+        r = &r->parent_unsafe();
+    }
+    return *l;
+}
+
 template <typename T>
 inline void transfer(Node<T>& from, Node<T>& to)
 {
@@ -0,0 +1,134 @@
+#include "spatial_index.h"
+#include "layout.h"
+#include "window.h"
+
+#include <algorithm>
+
+// Edge order follows Spatial_index::_Edge.
+static auto _edge_key(const Vector2D& rect, const unsigned edge) noexcept -> int
+{
+    switch (edge) {
+    case 0:  return rect.pos.x;
+    case 1:  return rect.pos.y;
+    case 2:  return rect.pos.x + rect.size.x;
+    default: return rect.pos.y + rect.size.y;
+    }
+}
+
+void Spatial_index::_insert(Window& window, const Vector2D& rect)
+{
+    for (unsigned edge = 0; edge < _edges.size(); ++edge)
+        _edges[edge].insert({_edge_key(rect, edge), &window});
+}
+
+void Spatial_index::_erase(Window& window, const Vector2D& rect) noexcept
+{
+    for (unsigned edge = 0; edge < _edges.size(); ++edge) {
+        [[maybe_unused]] const auto erased = _edges[edge].erase({_edge_key(rect, edge), &window});
+        assert(erased == 1);
+    }
+}
+
+void Spatial_index::insert(Window& window)
+{
+    assert(!_rects.contains(&window));
+    _rects.emplace(&window, window.rect());
+    _insert(window, window.rect());
+    window._spatial_index = this;
+}
+
+void Spatial_index::update(Window& window)
+{
+    auto* rect = _rects.find(&window);
+    assert(rect);
+    const Vector2D& new_rect = window.rect();
+    for (unsigned edge = 0; edge < _edges.size(); ++edge) {
+        const int key = _edge_key(new_rect, edge);
+        if (key == _edge_key(*rect, edge)) continue;
+        // Rekey the node in place of a new allocation.
+        auto node = _edges[edge].extract({_edge_key(*rect, edge), &window});
+        assert(node);
+        node.value().key = key;
+        _edges[edge].insert(std::move(node));
+    }
+    *rect = new_rect;
+}
+
+void Spatial_index::remove(Window& window) noexcept
+{
+    const auto* rect = _rects.find(&window);
+    assert(rect);
+    _erase(window, *rect);
+    _rects.erase(&window);
+    window._spatial_index = nullptr;
+}
+
+auto Spatial_index::nearest(const Vector2D& from, const Direction dir, const Window* exclude) const noexcept -> Hit
+{
+    const bool vertical = (dir == Direction::Up    || dir == Direction::Down);
+    const bool forward  = (dir == Direction::Right || dir == Direction::Down);
+    // Moving right means looking at left edges, and so on.
+    const auto& entries = _edges[forward ? (vertical ? top : left) : (vertical ? bottom : right)];
+
+    // Along the direction
+    const long lo     = vertical ? from.pos.y : from.pos.x;
+    const long hi     = lo + (vertical ? from.size.y : from.size.x);
+    const long center = (lo + hi) / 2;
+
+    Hit best;
+    // Returns false when no further entry can beat the best one.
+    const auto consider = [&](const _Entry& entry) {
+        const long distance = forward ? std::max(0L, entry.key - hi) : std::max(0L, lo - entry.key);
+        if (distance > best.score) return false;
+
+        const Window& window = *entry.window;
+        // Tabs hide windows without taking them out of the index.
+        if (&window == exclude || layout::is_hidden(window)) return true;
+
+        auto hit = spatial_index::rank(from, *_rects.find(&window), dir);
+        assert(hit);
+        hit->window = entry.window;
+        if (hit->better_than(best)) best = *hit;
+        return true;
+    };
+
+    if (forward) {
+        for (auto it = entries.upper_bound(center); it != entries.end(); ++it)
+            if (!consider(*it)) break;
+    } else {
+        for (auto it = entries.lower_bound(center); it != entries.begin();)
+            if (!consider(*--it)) break;
+    }
+    return best;
+}
+
+namespace spatial_index {
+
+auto rank(const Vector2D& from, const Vector2D& rect, const Direction dir) noexcept -> std::optional<Spatial_index::Hit>
+{
+    const bool vertical = (dir == Direction::Up    || dir == Direction::Down);
+    const bool forward  = (dir == Direction::Right || dir == Direction::Down);
+
+    // Along the direction
+    const long lo     = vertical ? from.pos.y : from.pos.x;
+    const long hi     = lo + (vertical ? from.size.y : from.size.x);
+    const long center = (lo + hi) / 2;
+    const long r_lo   = vertical ? rect.pos.y : rect.pos.x;
+    const long r_hi   = r_lo + (vertical ? rect.size.y : rect.size.x);
+    const long edge   = forward ? r_lo : r_hi;
+    if (forward ? edge <= center : edge >= center) return std::nullopt;
+
+    // Across the direction
+    const long p_lo = vertical ? from.pos.x : from.pos.y;
+    const long p_hi = p_lo + (vertical ? from.size.x : from.size.y);
+    const long c_lo = vertical ? rect.pos.x : rect.pos.y;
+    const long c_hi = c_lo + (vertical ? rect.size.x : rect.size.y);
+
+    const long distance = forward ? std::max(0L, edge - hi) : std::max(0L, lo - edge);
+    // Zero if both overlap across the direction.
+    const long gap = std::max({0L, c_lo - p_hi, p_lo - c_hi});
+
+    return Spatial_index::Hit{nullptr, distance + gap, std::abs((c_lo + c_hi) / 2 - (p_lo + p_hi) / 2)};
+}
+
+} // namespace spatial_index
@@ -0,0 +1,106 @@
+#pragma once
+#include "geometry.h"
+#include "helper/flat_map.h"
+
+#include <array>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <set>
+
+class Window;
+
+/**
+ * @brief Window rects ordered by each edge, for directional lookup.
+ * Each monitor indexes the windows of the workspace it shows,
+ * kept up to date by window rect updates.
+ * Insert, update and remove are O(log n), update never allocates.
+ */
+class Spatial_index
+{
+public:
+    struct Hit
+    {
+        Window* window = nullptr;
+        long    score  = std::numeric_limits<long>::max();
+        long    offset = std::numeric_limits<long>::max();
+
+        inline bool better_than(const Hit& other) const noexcept
+        { return (score != other.score) ? score < other.score : offset < other.offset; }
+    };
+
+private:
+    enum _Edge : unsigned char
+    {
+        left,
+        top,
+        right,
+        bottom,
+    };
+
+    struct _Entry
+    {
+        int     key;
+        Window* window;
+    };
+
+    // Ties on key are ordered by window, so an entry is found without a scan.
+    struct _Less
+    {
+        using is_transparent = void;
+
+        inline bool operator()(const _Entry& lhs, const _Entry& rhs) const noexcept
+        { return (lhs.key != rhs.key) ? lhs.key < rhs.key : std::less<>{}(lhs.window, rhs.window); }
+        inline bool operator()(const _Entry& lhs, const int key) const noexcept
+        { return lhs.key < key; }
+        inline bool operator()(const int key, const _Entry& rhs) const noexcept
+        { return key < rhs.key; }
+    };
+
+    std::array<std::set<_Entry, _Less>, 4>    _edges;
+    helper::Flat_map<const Window*, Vector2D> _rects;
+
+    void _insert(Window& window, const Vector2D& rect);
+    void _erase(Window& window, const Vector2D& rect) noexcept;
+
+public:
+    Spatial_index() noexcept = default;
+
+    Spatial_index(const Spatial_index&)      = delete;
+    auto operator=(const Spatial_index&)     = delete;
+
+    inline auto size() const noexcept -> std::size_t
+    { return _rects.size(); }
+
+    void insert(Window& window);
+    void update(Window& window);
+    void remove(Window& window) noexcept;
+
+    /**
+     * @brief Find nearest window from rect in a direction.
+     * Only windows past the center of rect and not behind a tab are considered.
+     * O(log n + k), k being the windows with an edge between the center and
+     * the best hit, ties on the same edge included. That's O(n) at worst,
+     * like looking up from under a row of windows sharing their bottom edge.
+     * @param from Rect to search from
+     * @param dir
+     * @param exclude Window to skip, usually the one at from
+     * @return Hit with null window if not found
+     */
+    auto nearest(const Vector2D& from, Direction dir, const Window* exclude) const noexcept -> Hit;
+};
+
+namespace spatial_index {
+
+/**
+ * @brief Rank a rect as seen from another one in a direction, as nearest does.
+ * Score is the distance along the direction plus the gap across it,
+ * offset is the distance between both centers across the direction.
+ * @param from
+ * @param rect
+ * @param dir
+ * @return Hit without window, std::nullopt if rect doesn't start past the center of from
+ */
+auto rank(const Vector2D& from, const Vector2D& rect, Direction dir) noexcept -> std::optional<Spatial_index::Hit>;
+
+} // namespace spatial_index
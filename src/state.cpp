@@ -1,5 +1,7 @@
 #include "state.h"
+#include "config.h"
 #include "keybind.h"
+#include "logger.h"
 
 #include "x11/monitor.h"
 #include "x11/window.h"
@@ -25,12 +27,24 @@ static void _assign_default_bindings(Manager<Binding>& manager)
     manager.manage<Move_container>({XKB_KEY_Right, mod_mask::mod4 | mod_mask::shift}, Direction::Right);
     manager.manage<Move_container>({XKB_KEY_Down,  mod_mask::mod4 | mod_mask::shift}, Direction::Down);
 
+    // Mod4 + Control + arrow
+    manager.manage<Resize>({XKB_KEY_Left,  mod_mask::mod4 | mod_mask::control}, Direction::Left);
+    manager.manage<Resize>({XKB_KEY_Up,    mod_mask::mod4 | mod_mask::control}, Direction::Up);
+    manager.manage<Resize>({XKB_KEY_Right, mod_mask::mod4 | mod_mask::control}, Direction::Right);
+    manager.manage<Resize>({XKB_KEY_Down,  mod_mask::mod4 | mod_mask::control}, Direction::Down);
+
     // Mod4 + v
     // Mod4 + h
     // Mod4 + t
     // Mod4 + space
     manager.manage<Change_layout_type>({XKB_KEY_v, mod_mask::mod4}, Layout::Containment_type::Vertical);
     manager.manage<Change_layout_type>({XKB_KEY_h, mod_mask::mod4}, Layout::Containment_type::Horizontal);
+    manager.manage<Change_layout_type>({XKB_KEY_t, mod_mask::mod4}, Layout::Containment_type::Tabbed);
+
+    // Mod4 + minus
+    // Mod4 + equal
+    manager.manage<Change_gap>({XKB_KEY_minus, mod_mask::mod4}, -config::GAP_STEP);
+    manager.manage<Change_gap>({XKB_KEY_equal, mod_mask::mod4},  config::GAP_STEP);
 
     // Mod4 + 1
     // ...
@@ -45,6 +59,23 @@ static void _assign_default_bindings(Manager<Binding>& manager)
     manager.manage<Switch_workspace>({XKB_KEY_9, mod_mask::mod4}, 8);
     manager.manage<Switch_workspace>({XKB_KEY_0, mod_mask::mod4}, 9);
 
+    // Mod4 + Control + 1
+    // ...
+    manager.manage<Move_to_workspace>({XKB_KEY_1, mod_mask::mod4 | mod_mask::control}, 0);
+    manager.manage<Move_to_workspace>({XKB_KEY_2, mod_mask::mod4 | mod_mask::control}, 1);
+    manager.manage<Move_to_workspace>({XKB_KEY_3, mod_mask::mod4 | mod_mask::control}, 2);
+    manager.manage<Move_to_workspace>({XKB_KEY_4, mod_mask::mod4 | mod_mask::control}, 3);
+    manager.manage<Move_to_workspace>({XKB_KEY_5, mod_mask::mod4 | mod_mask::control}, 4);
+    manager.manage<Move_to_workspace>({XKB_KEY_6, mod_mask::mod4 | mod_mask::control}, 5);
+    manager.manage<Move_to_workspace>({XKB_KEY_7, mod_mask::mod4 | mod_mask::control}, 6);
+    manager.manage<Move_to_workspace>({XKB_KEY_8, mod_mask::mod4 | mod_mask::control}, 7);
+    manager.manage<Move_to_workspace>({XKB_KEY_9, mod_mask::mod4 | mod_mask::control}, 8);
+    manager.manage<Move_to_workspace>({XKB_KEY_0, mod_mask::mod4 | mod_mask::control}, 9);
+
+#ifndef NDEBUG
+    // Mod4 + Shift + c
+    manager.manage<Check_state>({XKB_KEY_c, mod_mask::mod4 | mod_mask::shift});
+#endif
 }
 
 State::State(Connection &conn)
@@ -62,18 +93,21 @@ auto State::init(Connection& conn, X11::Server&) -> State&
     // First, load all monitors.
     X11::monitor::load_all(state);
     // Set current monitor to the first monitor.
-    state._current_monitor = &state.monitors().at(0);
+    state._current_monitor = state.monitors().handle(0);
     // Set default workspace.
-    state._current_workspace = &state.create_workspace(state.current_monitor());
+    state._current_workspace = state.workspaces().handle(
+            state.create_workspace(state.current_monitor()).index());
+    // Every monitor shows a workspace, so focus can move across them.
+    for (const auto& [_, monitor] : state.monitors())
+        if (monitor->empty()) state.create_workspace(*monitor);
 
-    // Focus current monitor and workspace.
-    auto it = std::ranges::find(state.current_monitor(), state.current_workspace());
-    state.current_monitor().current(it);
+    // Focus current monitor, it focuses its first workspace.
     state.current_monitor().focus();
     // Update monitor rect to update workspace rect.
-    state.current_monitor().update_rect();
+    monitor::update_rect_all(state.monitors());
 
     // Second, load all windows.
+    X11::ewmh::init_net_client_list();
     X11::window::load_all(state);
     // Focus the last window in the current workspace.
     if (state.current_workspace().has_window())
@@ -84,48 +118,73 @@ auto State::init(Connection& conn, X11::Server&) -> State&
 
     // Register emwh functions
     state.connect<State::current_workspace_update>([](const State& state) {
-        // Updating current workspace means updating current active window.
         X11::ewmh::update_net_current_desktop(state.current_workspace());
-        uint32_t window_id = state.current_workspace().has_window()
-                           ? state.current_workspace().current_window().index()
+    });
+    // Fires once focus settled, None only if no window is focused.
+    state.connect<State::current_window_update>([](const State& state) {
+        const auto& workspace = state.current_workspace();
+        uint32_t window_id = workspace.has_window() && workspace.current_window().focused()
+                           ? workspace.current_window().index()
                            : XCB_NONE;
         X11::ewmh::update_net_active_window(window_id);
     });
-    state.connect<State::window_manager_update>(X11::ewmh::update_net_client_list);
+    // Fires once at the end of a batch, so removed clients are written once.
+    state.connect<State::window_manager_update>([](const Manager<Window>&) {
+        X11::ewmh::flush_client_list();
+    });
     state.connect<State::workspace_manager_update>(X11::ewmh::update_net_desktop_names);
     state.connect<State::workspace_manager_update>(X11::ewmh::update_net_number_of_desktops);
+    state.connect<State::workspace_manager_update>(X11::ewmh::update_net_workarea);
     state.notify_all();
 
     return state;
 }
 
+#ifndef NDEBUG
+void State::check() const
+{
+    // Pending writes would make the list look out of order.
+    X11::ewmh::flush_client_list();
+    assert_debug(X11::ewmh::is_client_list_stacking_valid(),
+                 "_NET_CLIENT_LIST_STACKING doesn't match stacking order");
+    logger::debug("State check -> passed");
+}
+#endif
+
 void State::switch_workspace(Workspace& workspace) noexcept
 {
     // Current workspace must not be the same as specified workspace
     assert(current_workspace() != workspace);
     auto& last_workspace = current_workspace();
+    auto& monitor        = workspace.monitor();
+    // Workspace going hidden, the last one unless focus leaves its monitor.
+    auto& hidden         = monitor.current();
+    const bool cross     = (monitor != current_monitor());
 
-    if (workspace.monitor() != current_monitor()) {
-        // Set current monitor to workspace's monitor.
-        current_monitor().unfocus();
-        _current_monitor = &workspace.monitor();
-        // Set workspace as current workspace on monitor.
-        if (current_monitor().current() != workspace)
-            current_monitor().current(std::ranges::find(current_monitor(), workspace));
-        current_monitor().focus();
-        notify<signals::current_monitor_update>();
-    } else {
-        last_workspace.unfocus();
-        workspace.monitor().current(std::ranges::find(workspace.monitor(), workspace));
-        workspace.focus();
+    // Last workspace stays shown on its monitor when focus leaves it.
+    if (cross) current_monitor().unfocus();
+    else       last_workspace.unfocus();
+
+    if (hidden != workspace) {
+        // Map new windows first, then unmap the last ones, so nothing flickers.
+        // Stale rects are configured right before their map.
+        workspace.show_windows();
+        monitor.current(workspace);
+        hidden.hide_windows();
     }
 
-    _current_workspace = &workspace;
+    if (cross) {
+        _current_monitor = _mon_mgr.handle(monitor.index());
+        monitor.focus();
+        notify<signals::current_monitor_update>();
+    } else workspace.focus();
+
+    _current_workspace = _wor_mgr.handle(workspace.index());
     notify<signals::current_workspace_update>();
 
-    // Purge last workspace if empty.
-    if (last_workspace.size() == 1 && last_workspace.floating_layout().empty())
-        destroy_workspace(last_workspace.index());
+    // Purge hidden workspace if empty.
+    if (hidden != workspace && hidden.size() == 1 && hidden.floating_layout().empty())
+        destroy_workspace(hidden.index());
 }
 
 auto State::manage_window(const uint32_t window_id, Window::Display_type type) -> Window&
@@ -154,7 +213,7 @@ auto State::create_workspace(Monitor& monitor) -> Workspace&
 
 auto State::create_workspace(Monitor& monitor, Manager<Workspace>::Key workspace_id) -> Workspace&
 {
-    Workspace& workspace = _wor_mgr.manage(workspace_id);
+    Workspace& workspace = _wor_mgr.manage(workspace_id, _mon_mgr);
     monitor.add_child(workspace);
     monitor.update_rect();
     return workspace;
@@ -175,23 +234,63 @@ void State::destroy_workspace(Manager<Workspace>::Key workspace_id)
     assert_debug(!workspace.focused(), "Workspace must not be focused");
     Monitor& monitor = workspace.monitor();
     assert_debug(current_workspace() != workspace, "Can't destroy current workspace");
-    if (monitor.current() == workspace) {
-        if (monitor.size() > 1) {
-            monitor.current(std::ranges::prev(monitor.cend()));
-        } else {
-            assert(monitor != current_monitor());
-        }
-    }
-    monitor.remove_child(std::ranges::find(monitor, workspace));
+    // Monitor shows its last workspace instead if this one was shown.
+    assert(monitor.size() > 1 || monitor != current_monitor());
+    const bool shown = workspace.shown();
+    monitor.remove_child(workspace);
     _wor_mgr.unmanage(workspace.index());
+    if (shown && !monitor.empty()) monitor.current().show_windows();
+}
+
+void State::move_container_to_workspace(Node<Container>& node, Workspace& workspace)
+{
+    const auto batch = this->batch();
+    workspace::move_container(node, workspace);
+    notify<signals::current_workspace_update>();
+}
+
+void State::merge_workspace(Workspace& from, Workspace& to)
+{
+    const auto batch = this->batch();
+    workspace::merge(from, to);
+    const auto from_id = from.index();
+    // Switching away purges the empty workspace, unless it's left shown on another monitor.
+    if (from == current_workspace()) switch_workspace(to);
+    // Monitor keeps its last workspace even if empty.
+    if (_wor_mgr.contains(from_id) && _wor_mgr.at(from_id).monitor().size() > 1)
+        destroy_workspace(from_id);
+    notify<signals::current_workspace_update>();
+}
+
+void State::swap_workspace(Workspace& lhs, Workspace& rhs)
+{
+    const auto batch = this->batch();
+    workspace::swap(lhs, rhs);
+    notify<signals::current_workspace_update>();
 }
 
 State::~State() noexcept
 {
-    // Recursively clear the tree.
-    _mon_mgr.clear();
-    // Unrelated to above.
-    _bin_mgr.clear();
+    {
+        // Windows leave the tree, not the window manager, so its observers
+        // don't fire and the client list isn't rewritten while tearing down.
+        // Workspace observers fire once at the end, publishing no desktops.
+        const auto batch = this->batch();
+        // Recursively clear the tree, workspaces before the monitors referring to them.
+        _wor_mgr.clear();
+        _mon_mgr.clear();
+        // Unrelated to above.
+        _bin_mgr.clear();
+    }
+
+    const auto log_stats = [](std::string_view name, const helper::Pool_stats& stats) {
+        logger::info("{} pool -> allocations: {}, in use: {}, peak: {}, chunks: {}",
+                     name, stats.allocations, stats.in_use, stats.peak, stats.chunks);
+    };
+    log_stats("Layout",    Layout::pool_stats());
+    log_stats("Window",    Window::pool_stats());
+    log_stats("Workspace", Workspace::pool_stats());
+    logger::info("EWMH -> dropped root property writes: {}", X11::ewmh::dropped_writes());
 }
 
 
@@ -32,6 +32,7 @@ public:
     {
         current_workspace_update,
         current_monitor_update,
+        current_window_update,
         window_manager_update,
         monitor_manager_update,
         workspace_manager_update,
@@ -46,8 +47,8 @@ private:
     Manager<Monitor>&   _mon_mgr;
     Manager<Workspace>& _wor_mgr;
     // Current focused Workspace and Monitor and Workspace specific container
-    Workspace*          _current_workspace{};
-    Monitor*            _current_monitor{};
+    Manager<Workspace>::Handle _current_workspace;
+    Manager<Monitor>::Handle   _current_monitor;
 
 public:
     State(const State&)            = default;
@@ -83,17 +84,19 @@ public:
 
     /**
      * @brief Get current workspace.
+     * Throws if the handle is stale, current workspace is never unmanaged.
      * @return Reference to current workspace
      */
-    inline auto current_workspace() const noexcept -> Workspace&
-    { return *_current_workspace; }
+    inline auto current_workspace() const -> Workspace&
+    { return _wor_mgr.at(_current_workspace); }
 
     /**
      * @brief Get current monitor.
+     * Throws if the handle is stale, current monitor is never unmanaged.
      * @return Reference to current monitor
      */
-    inline auto current_monitor()   const noexcept -> Monitor&
-    { return *_current_monitor;   }
+    inline auto current_monitor()   const -> Monitor&
+    { return _mon_mgr.at(_current_monitor); }
 
 public:
     /**
@@ -115,12 +118,42 @@ public:
 
     void destroy_workspace(Manager<Workspace>::Key workspace_id);
 
+    /**
+     * @brief Move a container with all its windows to another workspace.
+     * @param node Window or layout
+     * @param workspace
+     */
+    void move_container_to_workspace(Node<Container>& node, Workspace& workspace);
+
+    /**
+     * @brief Move all windows of a workspace into another, then destroy it.
+     * @param from
+     * @param to
+     */
+    void merge_workspace(Workspace& from, Workspace& to);
+
+    /**
+     * @brief Swap contents of two workspaces.
+     * @param lhs
+     * @param rhs
+     */
+    void swap_workspace(Workspace& lhs, Workspace& rhs);
+
+#ifndef NDEBUG
+    /**
+     * @brief Check state against the display server.
+     * Needs round trips, so it only runs on demand.
+     */
+    void check() const;
+#endif
+
 private:
     template<signals sig>
     static inline constexpr auto _dispatch_observable(const State& state) noexcept -> const auto&
     {
         if constexpr (sig == current_workspace_update
-                   || sig == current_monitor_update)
+                   || sig == current_monitor_update
+                   || sig == current_window_update)
             return static_cast<const Observable<State>&>(state);
         else if constexpr(sig == window_manager_update)
             return static_cast<const Observable<Manager<Window>>&>(state.windows());
@@ -152,6 +185,29 @@ public:
         o.notify(sig);
     }
 
+    /**
+     * @brief Batch guard over State and its managers.
+     * Each pending signal fires once when the guard goes out of scope.
+     */
+    class Batch final
+    {
+        Observable<State>::Batch              _state;
+        Observable<Manager<Window>>::Batch    _windows;
+        Observable<Manager<Monitor>>::Batch   _monitors;
+        Observable<Manager<Workspace>>::Batch _workspaces;
+
+    public:
+        explicit Batch(const State& state) noexcept
+            : _state(state)
+            , _windows(state.windows())
+            , _monitors(state.monitors())
+            , _workspaces(state.workspaces())
+        {}
+    };
+
+    inline auto batch() const noexcept -> Batch
+    { return Batch(*this); }
+
     inline void notify_all() const
     {
         Observable<State>::notify_all();
@@ -2,10 +2,23 @@
 #include "layout.h"
 #include "workspace.h"
 #include "logger.h"
+#include "spatial_index.h"
 
 // For Window::Impl implementation.
 #include "x11/window.h"
 
+HELPER_POOL_ALLOCATED_DEFINE(Window)
+
+// Implementation is bound by display type, call it without vtable.
+template <typename Func>
+static inline void _visit_impl(Window::Display_type dt, Window::Impl& impl, Func&& func)
+{
+    switch (dt) {
+    case Window::Display_type::X11:
+        return func(static_cast<X11::Window_impl&>(impl));
+    default: std::unreachable();
+    }
+}
 
 Window::Window(unsigned int id, Display_type dt)
     : Managed(id)
@@ -32,12 +45,15 @@ Window::Window(unsigned int id, Display_type dt)
 
 void Window::_update_rect_fn() noexcept
 {
-    _impl->update_rect();
+    if (_spatial_index) _spatial_index->update(*this);
+    _visit_impl(_display_type, *_impl, [](auto& impl) { impl.update_rect(); });
 }
 
 void Window::_update_focus_fn() noexcept
 {
-    _impl->update_focus();
+    // Focused window must not be hidden behind another tab.
+    if (focused()) layout::reveal(*this);
+    _visit_impl(_display_type, *_impl, [](auto& impl) { impl.update_focus(); });
 }
 
 bool Window::is_marked() const noexcept
@@ -53,7 +69,7 @@ void Window::normalize() noexcept
 {
     if (_window_state != Window::State::Normal) {
         _window_state = Window::State::Normal;
-        _impl->update_state(Window::State::Normal);
+        _visit_impl(_display_type, *_impl, [](auto& impl) { impl.update_state(Window::State::Normal); });
     }
 }
 
@@ -61,7 +77,7 @@ void Window::minimize() noexcept
 {
     if (_window_state != Window::State::Minimized) {
         _window_state = Window::State::Minimized;
-        _impl->update_state(Window::State::Minimized);
+        _visit_impl(_display_type, *_impl, [](auto& impl) { impl.update_state(Window::State::Minimized); });
     }
 }
 
@@ -69,7 +85,7 @@ void Window::maximize() noexcept
 {
     if (_window_state != Window::State::Maximized) {
         _window_state = Window::State::Maximized;
-        _impl->update_state(Window::State::Maximized);
+        _visit_impl(_display_type, *_impl, [](auto& impl) { impl.update_state(Window::State::Maximized); });
     }
 }
 
@@ -87,10 +103,13 @@ void Window::set_floating() noexcept
 
 void Window::kill() noexcept
 {
-    _impl->kill();
+    _visit_impl(_display_type, *_impl, [](auto& impl) { impl.kill(); });
 }
 
-Window::~Window() noexcept = default;
+Window::~Window() noexcept
+{
+    if (_spatial_index) _spatial_index->remove(*this);
+}
 
 
 
@@ -144,7 +163,7 @@ void move_to_workspace(Window& window, Workspace& workspace)
                 move_to_marked_window(window, lm.value());
             } else {
                 auto &parent = current_window.parent()->get();
-                auto it      = std::ranges::find(parent, current_window);
+                auto it      = parent.iterator_to(current_window);
                 parent.insert_child(std::ranges::next(it), window);
                 parent.update_rect();
             }
@@ -170,37 +189,24 @@ void move_to_marked_window(Window& window, Window::Layout_mark& layout_mark)
     // If parent has one child, just change the type of layout.
     if (parent.size() > 1) {
         auto* layout = new Layout(mark);
-        parent.insert_child(std::ranges::find(parent, marked_window), *layout);
+        // New layout takes the place of marked window.
+        layout->weight(marked_window.weight());
+        marked_window.weight(1.0f);
+        parent.insert_child(parent.iterator_to(marked_window), *layout);
         parent.remove_child(marked_window);
         layout->add_child(marked_window);
         layout->add_child(window);
         parent.update_rect();
     } else {
+        auto& gparent = parent.parent_unsafe();
         parent.add_child(window);
         parent.type(mark);
+        // Parent might split the same way as its parent now.
+        if (&layout::compact(parent) != &parent)
+            gparent.update_rect();
     }
 }
 
-// returns false if fails.
-static bool _purge_sole_node(Node<Container>& node)
-{
-    assert(node.parent());
-    auto& parent = node.parent()->get();
-
-    // If node has one child, move its child into its parent.
-    if ((node.size() == 1) && (!node.back().is_leaf() || !parent.is_root())) {
-        Node<Container>& back = node.back();
-        node.erase_child(node.begin());
-        // Iterator invalidation, so search twice.
-        parent.insert_child(std::ranges::find(parent, node), back);
-        parent.erase_child(std::ranges::find(parent, node));
-        delete &node;
-
-        parent.update_rect();
-    } else return false;
-    return true;
-}
-
 void move_to_layout(Window& window, Layout& layout)
 {
     move_to_layout(window, layout, layout.cend());
@@ -210,9 +216,11 @@ void move_to_layout(Window& window, Layout& layout, Layout::const_iterator pos)
 {
     auto& parent = window.parent_unsafe();
     parent.remove_child(window);
+    window.weight(1.0f);
     layout.insert_child(pos, window);
-    _purge_sole_node(parent);
-    layout.parent_unsafe().update_rect();
+    // Layout might be gone after compaction, only window is safe to use.
+    auto& updated = layout::compact(parent);
+    get_common_ancestor(updated, window.parent_unsafe()).update_rect();
 }
 
 void purge_and_reconfigure(Window& window)
@@ -220,6 +228,7 @@ void purge_and_reconfigure(Window& window)
     assert(window.parent());
     auto& parent = window.parent()->get();
     parent.remove_child(window);
+    window.weight(1.0f);
 
     if (parent.empty()) {
         assert(parent.parent());
@@ -228,10 +237,10 @@ void purge_and_reconfigure(Window& window)
         gparent.remove_child(parent);
         delete &parent;
 
-        gparent.update_rect();
+        if (gparent.is_root()) gparent.update_rect();
+        else layout::compact(gparent).update_rect();
 
-    } else if (!_purge_sole_node(parent))
-        parent.update_rect();
+    } else layout::compact(parent).update_rect();
 }
 
 } // namespace window
@@ -5,15 +5,20 @@
 #include "layout.h"
 #include "managed.h"
 
+#include "helper/intrusive_list.h"
 #include "helper/memory.h"
+#include "helper/pool.h"
 
 #include <concepts>
 #include <vector>
 
+class Spatial_index;
 class Workspace;
 
 class Window final : public Leaf<Container>
                    , public Managed<unsigned int>
+                   // Workspace focus order
+                   , public helper::List_hook<Window>
 {
 public:
     enum class Display_type
@@ -76,7 +81,11 @@ private:
     Placement_mode      _placement_mode;
     Layout_mark         _layout_mark;
     memory::owner<Impl> _impl;
+    // Index of the monitor showing this window, if any.
+    Spatial_index*      _spatial_index{};
 
+    friend class Container;
+    friend class Spatial_index;
     void _update_rect_fn()  noexcept override;
     void _update_focus_fn() noexcept override;
 
@@ -97,6 +106,13 @@ public:
         return _placement_mode;
     }
 
+    // Display implementation, T must match display_type().
+    template <std::derived_from<Impl> T>
+    inline auto impl() noexcept -> T&
+    {
+        return static_cast<T&>(*_impl);
+    }
+
     // Get layout mark
     inline auto layout_mark() -> std::optional<Layout_mark>
     {
@@ -153,6 +169,8 @@ public:
      */
     void kill() noexcept;
 
+    HELPER_POOL_ALLOCATED_DECLARE()
+
     ~Window() noexcept override;
 };
 
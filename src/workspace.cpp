@@ -1,39 +1,64 @@
 #include "workspace.h"
 #include "config.h"
+#include "monitor.h"
 #include "window.h"
 #include "logger.h"
 #include <algorithm>
 #include <stdexcept>
+#include <vector>
+
+HELPER_POOL_ALLOCATED_DEFINE(Workspace)
 
 void Workspace::_Window_list::add(Window& window) noexcept
 {
     if (!empty() && current().focused())
         current().unfocus();
-    _list.push_front(&window);
+    _list.push_front(window);
+}
+
+void Workspace::_Window_list::append(Window& window) noexcept
+{
+    _list.push_back(window);
 }
 
-void Workspace::_Window_list::focus(const_iterator it) noexcept
+void Workspace::_Window_list::focus(Window& window) noexcept
 {
     assert(!empty());
     if (current().focused())
         current().unfocus();
 
-    Window& window = *it;
-    _list.erase(it);
-    _list.push_front(&window);
+    _list.move_to_front(window);
     window.focus();
 }
 
-void Workspace::_Window_list::remove(const_iterator it) noexcept
+void Workspace::_Window_list::remove(Window& window) noexcept
+{
+    if (window.focused())
+        window.unfocus();
+
+    _list.erase(window);
+}
+
+void Workspace::_Window_list::splice_front(_Window_list& other) noexcept
+{
+    if (!empty() && current().focused())
+        current().unfocus();
+    _list.splice_front(other._list);
+}
+
+void Workspace::_Window_list::splice_back(_Window_list& other) noexcept
 {
-    if (it->focused())
-        it->unfocus();
+    _list.splice_back(other._list);
+}
 
-    _list.erase(it);
+void Workspace::_Window_list::swap(_Window_list& other) noexcept
+{
+    _list.swap(other._list);
 }
 
-Workspace::Workspace(const Index id)
+Workspace::Workspace(const Index id, const Manager<Monitor>& monitors)
     : Managed(id)
+    , _monitor_mgr(monitors)
     // by default the name is the id.
     , _name(std::to_string(id + 1))
 {
@@ -41,36 +66,62 @@ Workspace::Workspace(const Index id)
     this->add_child(*floating_layout);
 }
 
+auto Workspace::monitor() const -> Monitor&
+{
+    assert(_monitor);
+    return _monitor_mgr.at(_monitor);
+}
+
+bool Workspace::shown() const noexcept
+{
+    return _monitor && monitor().current() == *this;
+}
+
 void Workspace::_update_rect_fn() noexcept
 {
     const auto& rect = this->rect();
     logger::debug("Workspace rect update -> x: {}, y: {}, width: {}, height: {}",
                   rect.pos.x, rect.pos.y, rect.size.x, rect.size.y);
-    for (auto& lcon : *this) {
-        lcon.rect({
-            { rect.pos.x + (int)config::GAP_SIZE, rect.pos.y + (int)config::GAP_SIZE },
-            { rect.size.x - 2 * (int)config::GAP_SIZE, rect.size.y - 2 * (int)config::GAP_SIZE }
-        });
-    }
+    // Workspace children are always layouts.
+    for (auto& lcon : *this)
+        static_cast<Layout&>(lcon).rect<Layout>(workspace::layout_rect(rect));
 }
 
 void Workspace::_update_focus_fn() noexcept
 {
     if (focused()) {
-        for (auto& window : _window_list) window.normalize();
-
+        show_windows();
         if (!_window_list.empty()) _window_list.current().focus();
     } else {
+        // Stays shown while its monitor isn't focused.
         if (!_window_list.empty()) _window_list.current().unfocus();
-
-        for (auto& window : _window_list) window.minimize();
     }
 }
 
+void Workspace::show_windows() noexcept
+{
+    // Normalize does nothing on windows already shown.
+    for (auto& window : _window_list)
+        if (!layout::is_hidden(window)) window.normalize();
+}
+
+void Workspace::hide_windows() noexcept
+{
+    for (auto& window : _window_list) window.minimize();
+}
+
 void Workspace::add_window(Window& window) noexcept
 {
-    assert(std::ranges::find(_window_list, window) == _window_list.cend());
+    assert(!window.is_linked());
     _window_list.add(window);
+    if (shown()) monitor()._spatial_index.insert(window);
+}
+
+void Workspace::append_window(Window& window) noexcept
+{
+    assert(!window.is_linked());
+    _window_list.append(window);
+    if (shown()) monitor()._spatial_index.insert(window);
 }
 
 void Workspace::focus_window(Window& window) noexcept
@@ -80,24 +131,213 @@ void Workspace::focus_window(Window& window) noexcept
         if (window.focused()) window.unfocus();
         window.focus();
     } else if (window != _window_list.current()) {
-        auto it = std::ranges::find(_window_list, window);
-        assert(it != _window_list.cend());
-        _window_list.focus(it);
+        assert(window.is_linked() && window.root<Workspace>() == *this);
+        _window_list.focus(window);
     }
 }
 
 void Workspace::remove_window(Window& window) noexcept
 {
-    auto it = std::ranges::find(_window_list, window);
-    assert(it != _window_list.cend());
-    _window_list.remove(it);
+    assert(window.is_linked());
+    _window_list.remove(window);
+    if (shown()) monitor()._spatial_index.remove(window);
+}
+
+void Workspace::_index(const _Window_list& windows) noexcept
+{
+    if (!shown()) return;
+    auto& spatial_index = monitor()._spatial_index;
+    for (auto& window : windows) spatial_index.insert(window);
+}
+
+void Workspace::_unindex(const _Window_list& windows) noexcept
+{
+    if (!shown()) return;
+    auto& spatial_index = monitor()._spatial_index;
+    for (auto& window : windows) spatial_index.remove(window);
+}
+
+void Workspace::take_windows(Workspace& from) noexcept
+{
+    assert(from != *this);
+    _Window_list moved;
+    for (auto it = from._window_list.begin(); it != from._window_list.end();) {
+        Window& window = *it++;
+        // Cached root already points here for the linked subtree.
+        if (window.root<Workspace>() != *this) continue;
+        from.remove_window(window);
+        moved.append(window);
+    }
+    _index(moved);
+    _window_list.splice_front(moved);
+}
+
+void Workspace::append_windows(Workspace& from) noexcept
+{
+    assert(from != *this);
+    if (!from._window_list.empty() && from._window_list.current().focused())
+        from._window_list.current().unfocus();
+    from._unindex(from._window_list);
+    _index(from._window_list);
+    _window_list.splice_back(from._window_list);
+}
+
+void Workspace::swap_windows(Workspace& other) noexcept
+{
+    assert(other != *this);
+    for (auto* list : {&_window_list, &other._window_list})
+        if (!list->empty() && list->current().focused()) list->current().unfocus();
+    _unindex(_window_list);
+    other._unindex(other._window_list);
+    _window_list.swap(other._window_list);
+    _index(_window_list);
+    other._index(other._window_list);
 }
 
 Workspace::~Workspace() noexcept
 {
-    for (const auto& c : *this) delete &c;
+    // Unlink before delete, iterating would read links of a deleted child.
+    while (!empty()) {
+        auto& child = front();
+        remove_child(child);
+        delete &child;
+    }
 }
 
 namespace workspace {
 
+auto layout_rect(const Vector2D& rect) noexcept -> Vector2D
+{
+    return {
+        { rect.pos.x + (int)config::gap_size, rect.pos.y + (int)config::gap_size },
+        { rect.size.x - 2 * (int)config::gap_size, rect.size.y - 2 * (int)config::gap_size }
+    };
+}
+
+static auto _take_floating(Workspace& workspace) -> std::vector<Node<Container>*>
+{
+    std::vector<Node<Container>*> nodes;
+    Layout& floating_layout = workspace.floating_layout();
+    while (!floating_layout.empty()) {
+        nodes.push_back(&floating_layout.front());
+        floating_layout.erase_child(floating_layout.begin());
+    }
+    return nodes;
+}
+
+static auto _take_tiling(Workspace& workspace) -> Layout*
+{
+    if (workspace.size() != 2) return nullptr;
+    Layout& tiling_layout = workspace.tiling_layout();
+    workspace.remove_child(tiling_layout);
+    return &tiling_layout;
+}
+
+// Delete layouts left empty, then compact what's left.
+static void _purge_empty(Node<Container>& node)
+{
+    Node<Container>* n = &node;
+    while (!n->is_root() && n->empty()) {
+        Node<Container>& parent = n->parent_unsafe();
+        parent.remove_child(*n);
+        delete n;
+        n = &parent;
+    }
+    if (!n->is_root()) layout::compact(*n);
+}
+
+static void _attach_tiling(Node<Container>& node, Workspace& to)
+{
+    node.weight(1.0f);
+    if (to.size() == 1) {
+        if (node.is_leaf()) {
+            auto* layout = new Layout(Layout::Containment_type::Horizontal);
+            layout->add_child(node);
+            to.add_child(*layout);
+        } else to.add_child(node);
+    } else {
+        to.tiling_layout().add_child(node);
+        // Nested layout might split the same way as its new parent.
+        if (!node.is_leaf()) layout::compact(node);
+    }
+}
+
+// Bring windows in line with workspace visibility, they may have moved in or behind a tab.
+static void _show_or_hide(Workspace& workspace)
+{
+    const bool shown = workspace.shown();
+    for (auto& window : workspace.windows()) {
+        if (shown && !layout::is_hidden(window)) window.normalize();
+        else window.minimize();
+    }
+}
+
+static void _refocus(Workspace& workspace)
+{
+    if (workspace.focused() && workspace.has_window() && !workspace.current_window().focused())
+        workspace.current_window().focus();
+}
+
+void move_container(Node<Container>& node, Workspace& to)
+{
+    assert(node.parent() && !node.is_root());
+    Workspace& from = node.root<Workspace>();
+    assert(from != to);
+    assert(node != from.floating_layout());
+
+    Node<Container>& parent = node.parent_unsafe();
+    parent.remove_child(node);
+    if (parent == from.floating_layout()) {
+        to.floating_layout().add_child(node);
+    } else {
+        _purge_empty(parent);
+        _attach_tiling(node, to);
+    }
+    to.take_windows(from);
+
+    from.update_rect();
+    to.update_rect();
+    _show_or_hide(to);
+    _refocus(from);
+    _refocus(to);
+}
+
+void merge(Workspace& from, Workspace& to)
+{
+    assert(from != to);
+    const auto floating = _take_floating(from);
+
+    for (auto* node : floating) to.floating_layout().add_child(*node);
+    if (auto* tiling_layout = _take_tiling(from))
+        _attach_tiling(*tiling_layout, to);
+    to.append_windows(from);
+
+    from.update_rect();
+    to.update_rect();
+    _show_or_hide(to);
+    _refocus(to);
+}
+
+void swap(Workspace& lhs, Workspace& rhs)
+{
+    assert(lhs != rhs);
+    const auto lhs_floating = _take_floating(lhs);
+    const auto rhs_floating = _take_floating(rhs);
+    auto* const lhs_tiling  = _take_tiling(lhs);
+    auto* const rhs_tiling  = _take_tiling(rhs);
+
+    for (auto* node : rhs_floating) lhs.floating_layout().add_child(*node);
+    for (auto* node : lhs_floating) rhs.floating_layout().add_child(*node);
+    if (rhs_tiling) lhs.add_child(*rhs_tiling);
+    if (lhs_tiling) rhs.add_child(*lhs_tiling);
+    lhs.swap_windows(rhs);
+
+    lhs.update_rect();
+    rhs.update_rect();
+    _show_or_hide(lhs);
+    _show_or_hide(rhs);
+    _refocus(lhs);
+    _refocus(rhs);
+}
+
 } // namespace workspace
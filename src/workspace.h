@@ -1,7 +1,9 @@
 #pragma once
 #include "layout.h"
 #include "managed.h"
-#include "helper/pointer_wrapper.h"
+#include "manager.h"
+#include "helper/intrusive_list.h"
+#include "helper/pool.h"
 
 class Window;
 class Monitor;
@@ -9,38 +11,56 @@ class Monitor;
 class Workspace final : public Root<Container>
                       , public Managed<unsigned int>
 {
+    // Most recently focused first.
     class _Window_list
     {
-        std::list<Window*> _list;
+        helper::Intrusive_list<Window> _list;
 
     public:
-        HELPER_POINTER_ITERATOR_WRAPPER(_list);
+        inline auto begin() const noexcept -> helper::Intrusive_list<Window>::iterator
+        { return _list.begin(); }
+
+        inline auto end()   const noexcept -> helper::Intrusive_list<Window>::iterator
+        { return _list.end(); }
 
         inline auto current() const noexcept -> Window&
-        { return *_list.front(); }
+        { return _list.front(); }
 
         inline bool empty() const noexcept
         { return _list.empty(); }
 
         public:
-        void add(Window& window)       noexcept;
-        void focus(const_iterator it)  noexcept;
-        void remove(const_iterator it) noexcept;
+        void add(Window& window)    noexcept;
+        void append(Window& window) noexcept;
+        void focus(Window& window)  noexcept;
+        void remove(Window& window) noexcept;
+        // Splice all windows of other before the current one, it's unfocused.
+        void splice_front(_Window_list& other) noexcept;
+        void splice_back(_Window_list& other)  noexcept;
+        void swap(_Window_list& other)         noexcept;
     };
 
     friend class Monitor;
-    Monitor*     _monitor;
+    // Monitor is resolved through its manager, unset while detached.
+    const Manager<Monitor>& _monitor_mgr;
+    helper::Handle<Monitor> _monitor;
     std::string  _name;
     _Window_list _window_list;
 
+    friend class Container;
     void _update_rect_fn()  noexcept override;
     void _update_focus_fn() noexcept override;
+    // Monitor indexes windows of the workspace it shows.
+    void _index(const _Window_list& windows)   noexcept;
+    void _unindex(const _Window_list& windows) noexcept;
 
 public:
-    explicit Workspace(Index id);
+    Workspace(Index id, const Manager<Monitor>& monitors);
+
+    auto monitor() const -> Monitor&;
 
-    inline auto monitor() const noexcept -> Monitor&
-    { assert(_monitor); return *_monitor; }
+    // Current workspace of its monitor, focused or not.
+    bool shown() const noexcept;
 
     inline auto name() const noexcept -> std::string_view
     { return _name; }
@@ -65,11 +85,84 @@ public:
     inline auto current_window() const noexcept -> Window&
     { return _window_list.current(); }
 
+    // Windows, most recently focused first.
+    inline auto windows() const noexcept -> const _Window_list&
+    { return _window_list; }
+
 public:
 
     void add_window(Window& window)    noexcept;
+    // Add window as the least recently focused one, current window stays.
+    void append_window(Window& window) noexcept;
     void focus_window(Window& window)  noexcept;
     void remove_window(Window& window) noexcept;
+    // Show windows not behind a tab, focus does it too.
+    // Called earlier when switching, so they show up before the last workspace hides.
+    void show_windows()                noexcept;
+    // Hide all windows, once another workspace is shown on the monitor.
+    void hide_windows()                noexcept;
+
+    /**
+     * @brief Take windows whose subtree was linked here from another workspace.
+     * They keep their focus order and become the most recent ones,
+     * like moving them one by one. Walks the windows of from once.
+     * @param from
+     */
+    void take_windows(Workspace& from) noexcept;
+
+    /**
+     * @brief Take all windows of another workspace as the least recently focused ones.
+     * Lists are spliced, windows are only walked if either workspace is shown.
+     * @param from
+     */
+    void append_windows(Workspace& from) noexcept;
+
+    /**
+     * @brief Exchange windows with another workspace, focus order included.
+     * Lists are swapped, windows are only walked if either workspace is shown.
+     * @param other
+     */
+    void swap_windows(Workspace& other) noexcept;
+
+    HELPER_POOL_ALLOCATED_DECLARE()
 
     ~Workspace() noexcept override;
-};
\ No newline at end of file
+};
+
+namespace workspace {
+
+/**
+ * @brief Get rect of workspace layouts.
+ * @param rect Workspace rect
+ * @return Workspace rect without gap
+ */
+auto layout_rect(const Vector2D& rect) noexcept -> Vector2D;
+
+/**
+ * @brief Move a container with all its windows to another workspace.
+ * Subtree is linked as a whole, both workspaces are reconfigured once.
+ * Moved windows keep their focus order, the focused one stays current.
+ * Still O(n): subtree gets its cached root relinked, windows of from are walked once.
+ * @param node Window or layout, not the floating layout
+ * @param to
+ */
+void move_container(Node<Container>& node, Workspace& to);
+
+/**
+ * @brief Move all windows of a workspace into another one.
+ * Tiling tree of from is nested into tiling tree of to, leaving from empty.
+ * Focus order is spliced, the moved tree still gets its cached root relinked.
+ * @param from
+ * @param to
+ */
+void merge(Workspace& from, Workspace& to);
+
+/**
+ * @brief Swap contents of two workspaces, focus order included.
+ * Focus orders are swapped, both trees still get their cached root relinked.
+ * @param lhs
+ * @param rhs
+ */
+void swap(Workspace& lhs, Workspace& rhs);
+
+} // namespace workspace
@@ -39,6 +39,7 @@ xmacro(_NET_CURRENT_DESKTOP) \
 xmacro(_NET_NUMBER_OF_DESKTOPS) \
 xmacro(_NET_DESKTOP_NAMES) \
 xmacro(_NET_DESKTOP_VIEWPORT) \
+xmacro(_NET_WORKAREA) \
 xmacro(_NET_ACTIVE_WINDOW) \
 xmacro(_NET_CLOSE_WINDOW) \
 xmacro(_NET_MOVERESIZE_WINDOW) \
@@ -48,7 +49,6 @@ xmacro(_NET_SHOWING_DESKTOP)
 SUPPORTED_ATOMS_XMACRO \
 xmacro(_NET_WM_USER_TIME) \
 xmacro(_NET_STARTUP_ID) \
-xmacro(_NET_WORKAREA) \
 xmacro(_NET_REQUEST_FRAME_EXTENTS) \
 xmacro(_NET_SYSTEM_TRAY_ORIENTATION) \
 xmacro(_NET_SYSTEM_TRAY_VISUAL) \
@@ -1,6 +1,8 @@
 #include "event.h"
 #include "atom.h"
+#include "ewmh.h"
 #include "extension.h"
+#include "monitor.h"
 #include "window.h"
 
 #include "../config.h"
@@ -8,8 +10,10 @@
 #include "../state.h"
 #include "../server.h"
 
+#include <optional>
 #include <ranges>
 #include <xcb/xproto.h>
+#include <xcb/randr.h>
 #include <xkbcommon/xkbcommon.h>
 #define explicit _explicit
 #include <xcb/xkb.h>
@@ -20,6 +24,7 @@
 xmacro(DESTROY_NOTIFY, destroy_notify) \
 xmacro(UNMAP_NOTIFY, unmap_notify) \
 xmacro(MAP_REQUEST, map_request) \
+xmacro(CONFIGURE_REQUEST, configure_request) \
 xmacro(ENTER_NOTIFY, enter_notify) \
 xmacro(FOCUS_IN, focus_in) \
 xmacro(FOCUS_OUT, focus_out) \
@@ -41,6 +46,12 @@ namespace X11::event {
 
 static std::unordered_map<xcb_window_t, uint32_t> _ignored_unmap_ids;
 
+// Sequence of the request ending the last layout commit,
+// reset once an event past it arrives.
+static std::optional<uint16_t> _layout_fence;
+static bool                    _layout_pending;
+static bool                    _focus_pending;
+
 #define xmacro(key, name) static void _on_##name (State& state, const xcb_##name##_event_t& event);
     SUPPORTED_EVENTS
     SUPPORTED_XKB_EVENTS
@@ -78,6 +89,11 @@ void handle(State& state, const Event& event)
 {
     const int type = event.data->response_type & ~0x80;
 
+    // Events come in order, everything from now on is past the commit.
+    // Sequence on the wire is 16 bits, compare with wrap around.
+    if (_layout_fence && static_cast<int16_t>(event.data->sequence - *_layout_fence) >= 0)
+        _layout_fence.reset();
+
     switch (type) {
     #define xmacro(key, name) \
     case XCB_##key: \
@@ -88,6 +104,10 @@ void handle(State& state, const Event& event)
     default:
         if (extension::xkb().is_supported && type == extension::xkb().base_event)
             _handle_xkb(state, event);
+        else if (extension::xrandr().is_supported
+              && (type == extension::xrandr().base_event + XCB_RANDR_SCREEN_CHANGE_NOTIFY
+               || type == extension::xrandr().base_event + XCB_RANDR_NOTIFY))
+            monitor::screen_changed();
         else
             logger::debug("Event handler -> Unhandled event type: {}", type);
         break;
@@ -110,6 +130,31 @@ bool is_unmap_ignored(xcb_window_t window_id)
     return false;
 }
 
+void layout_changed() noexcept
+{
+    _layout_pending = true;
+}
+
+void commit_layout() noexcept
+{
+    if (!_layout_pending) return;
+    _layout_pending = false;
+    // Crossing events caused by the layout carry sequence of an earlier request.
+    _layout_fence = static_cast<uint16_t>(xcb_no_operation(X11::detail::conn()).sequence);
+}
+
+void focus_changed() noexcept
+{
+    _focus_pending = true;
+}
+
+void commit_focus(const State& state)
+{
+    if (!_focus_pending) return;
+    _focus_pending = false;
+    state.notify<State::current_window_update>();
+}
+
 // Implementations for each event
 
 void _on_destroy_notify(State& state, const xcb_destroy_notify_event_t& event)
@@ -137,6 +182,8 @@ void _on_unmap_notify(State& state, const xcb_unmap_notify_event_t& event)
         state.unmanage_window(event.window);
         xcb_delete_property(state.conn(), event.window, atom::_NET_WM_DESKTOP);
         xcb_delete_property(state.conn(), event.window, atom::_NET_WM_STATE);
+    } else if (window::unmanage_dock(event.window, state)) {
+        logger::debug("Unmap notify -> unmapped dock: {:#x}", event.window);
     } else {
         logger::debug("Unmap notify -> ignoring unmanaged window: {:#x}", event.window);
         return;
@@ -153,6 +200,7 @@ void _on_map_request(State& state, const xcb_map_request_event_t& event)
         if (workspace == state.current_workspace()) {
             logger::debug("Map request -> remapping managed window: {:#x}", window.index());
             xcb_map_window(state.conn(), window.index());
+            window::raise(window.index());
             workspace.focus_window(window);
         }
     } else {
@@ -160,11 +208,68 @@ void _on_map_request(State& state, const xcb_map_request_event_t& event)
     }
 }
 
+// Forward the request as is, for windows we don't manage.
+static void _forward_configure_request(const xcb_configure_request_event_t& event)
+{
+    uint32_t values[7];
+    int      count = 0;
+    if (event.value_mask & XCB_CONFIG_WINDOW_X)            values[count++] = event.x;
+    if (event.value_mask & XCB_CONFIG_WINDOW_Y)            values[count++] = event.y;
+    if (event.value_mask & XCB_CONFIG_WINDOW_WIDTH)        values[count++] = event.width;
+    if (event.value_mask & XCB_CONFIG_WINDOW_HEIGHT)       values[count++] = event.height;
+    if (event.value_mask & XCB_CONFIG_WINDOW_BORDER_WIDTH) values[count++] = event.border_width;
+    if (event.value_mask & XCB_CONFIG_WINDOW_SIBLING)      values[count++] = event.sibling;
+    if (event.value_mask & XCB_CONFIG_WINDOW_STACK_MODE)   values[count++] = event.stack_mode;
+    xcb_configure_window(X11::detail::conn(), event.window, event.value_mask, values);
+}
+
+void _on_configure_request(State& state, const xcb_configure_request_event_t& event)
+{
+    const auto& winref = state.windows()[event.window];
+    if (!winref) {
+        logger::debug("Configure request -> forwarding for unmanaged window: {:#x}", event.window);
+        _forward_configure_request(event);
+        return;
+    }
+
+    auto& window = winref->get();
+    window.impl<Window_impl>().count_configure_request();
+    if (window.placement_mode() == Window::Placement_mode::Tiling) {
+        // Geometry is decided by layout, tell the client what it already has.
+        window::send_configure_notify(window.index(), window.impl<Window_impl>().configured_rect());
+        return;
+    }
+
+    Vector2D rect = window.rect();
+    if (event.value_mask & XCB_CONFIG_WINDOW_X)      rect.pos.x  = event.x;
+    if (event.value_mask & XCB_CONFIG_WINDOW_Y)      rect.pos.y  = event.y;
+    if (event.value_mask & XCB_CONFIG_WINDOW_WIDTH)  rect.size.x = event.width;
+    if (event.value_mask & XCB_CONFIG_WINDOW_HEIGHT) rect.size.y = event.height;
+    window.rect(rect);
+
+    // Sibling is ignored, window goes to the very top or bottom like the client list.
+    if (event.value_mask & XCB_CONFIG_WINDOW_STACK_MODE) {
+        if (event.stack_mode == XCB_STACK_MODE_ABOVE) {
+            window::raise(window.index());
+        } else if (event.stack_mode == XCB_STACK_MODE_BELOW) {
+            const uint32_t values[] = { XCB_STACK_MODE_BELOW };
+            xcb_configure_window(state.conn(), window.index(), XCB_CONFIG_WINDOW_STACK_MODE, values);
+            ewmh::restack_client(window.index(), false);
+        }
+    }
+}
+
 void _on_enter_notify(State& state, const xcb_enter_notify_event_t& event)
 {
+    Timestamp::update(event.time);
     if (event.mode != XCB_NOTIFY_MODE_NORMAL || event.detail == XCB_NOTIFY_DETAIL_INFERIOR)
         return;
 
+    if (_layout_fence) {
+        logger::debug("Enter notify -> ignoring, caused by layout change");
+        return;
+    }
+
     if (const auto& winref = state.windows()[event.event]) {
         logger::debug("Enter notify -> window is managed");
         ::window::try_focus_window(winref->get());
@@ -254,6 +359,7 @@ void _on_focus_out(State&, const xcb_focus_out_event_t& event)
 
 void _on_button_press(State& state, const xcb_button_press_event_t& event)
 {
+    Timestamp::update(event.time);
     logger::debug("Button press -> x: {}, y: {}, window: {:#x}", event.event_x, event.event_y, event.event);
     if (event.child != XCB_NONE) {
         if (const auto& winref = state.windows()[event.child]) {
@@ -266,11 +372,13 @@ void _on_button_press(State& state, const xcb_button_press_event_t& event)
 
 void _on_button_release(State&, const xcb_button_release_event_t& event)
 {
+    Timestamp::update(event.time);
     logger::debug("Button release -> x: {}, y: {}, window: {:#x}", event.event_x, event.event_y, event.event);
 }
 
 void _on_key_press(State& state, const xcb_key_press_event_t& event)
 {
+    Timestamp::update(event.time);
     Keybind keybind = XKB::create_keybind(event.detail, event.state);
 #ifndef NDEBUG
     {
@@ -287,6 +395,7 @@ void _on_key_press(State& state, const xcb_key_press_event_t& event)
 
 void _on_key_release(State&, const xcb_key_release_event_t& event)
 {
+    Timestamp::update(event.time);
 #ifndef NDEBUG
     Keybind keybind = XKB::create_keybind(event.detail, event.state);
     char keysym_name[32];
@@ -295,6 +404,7 @@ void _on_key_release(State&, const xcb_key_release_event_t& event)
 #endif
 }
 
+// Root doesn't select motion, this only comes during a pointer grab.
 void _on_motion_notify(State&, const xcb_motion_notify_event_t& event)
 {
     Timestamp::update(event.time);
@@ -311,6 +421,13 @@ void _on_selection_clear(State&, const xcb_selection_clear_event_t& event)
 
 void _on_property_notify(State& state, const xcb_property_notify_event_t& event)
 {
+    Timestamp::update(event.time);
+    if (event.atom == atom::_NET_WM_STRUT_PARTIAL) {
+        window::update_dock(event.window, state);
+    } else if (event.atom == XCB_ATOM_WM_NORMAL_HINTS) {
+        if (const auto& winref = state.windows()[event.window])
+            winref->get().impl<Window_impl>().update_normal_hints();
+    }
 }
 
 void _on_client_message(State& state, const xcb_client_message_event_t& event)
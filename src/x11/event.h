@@ -20,6 +20,14 @@ void init(const X11::Connection& conn);
 void handle(State& state, const Event& event);
 void ignore_unmap(xcb_window_t window_id);
 bool is_unmap_ignored(xcb_window_t window_id);
+// Windows moved, mapped or unmapped, pointer may now be over another window.
+void layout_changed() noexcept;
+// Fence pending layout changes, EnterNotify generated before it is ignored.
+void commit_layout() noexcept;
+// A window gained or lost focus.
+void focus_changed() noexcept;
+// Let state publish focus once it settled, if it changed.
+void commit_focus(const State& state);
 }
 }
 
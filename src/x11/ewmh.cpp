@@ -7,9 +7,37 @@
 #include "../logger.h"
 
 #include <algorithm>
+#include <optional>
 
 namespace X11::ewmh {
 
+// Root properties are watched by bars and pagers, each write wakes all of them.
+// Keep the last written values to drop writes that wouldn't change anything.
+static std::optional<xcb_window_t>          _active_window;
+static std::optional<uint32_t>              _current_desktop;
+static std::optional<uint32_t>              _number_of_desktops;
+static std::optional<std::vector<char>>     _desktop_names;
+static std::optional<bool>                  _showing_desktop;
+static std::optional<std::vector<uint32_t>> _workarea;
+static std::size_t                          _dropped_writes = 0;
+
+// returns false if value is the same as the last written one.
+template <typename T>
+static bool _update_cache(std::optional<T>& cache, const T& value)
+{
+    if (cache == value) {
+        ++_dropped_writes;
+        return false;
+    }
+    cache = value;
+    return true;
+}
+
+auto dropped_writes() noexcept -> std::size_t
+{
+    return _dropped_writes;
+}
+
 void update_net_supported(std::span<xcb_atom_t> atoms)
 {
     window::change_property(X11::detail::root_window_id(),
@@ -48,6 +76,7 @@ void update_net_supporting_wm_check(xcb_window_t window_id)
 
 void update_net_active_window(xcb_window_t window_id)
 {
+    if (!_update_cache(_active_window, window_id)) return;
     // Looks like many window ids, but in fact, it's only one.
     const uint32_t window_ids[] = { window_id };
     window::change_property(X11::detail::root_window_id(),
@@ -60,6 +89,7 @@ void update_net_active_window(xcb_window_t window_id)
 
 void update_net_current_desktop(const Workspace& workspace)
 {
+    if (!_update_cache(_current_desktop, workspace.index())) return;
     const uint32_t workspace_ids[] = { workspace.index() };
     window::change_property(X11::detail::root_window_id(),
                             window::prop::replace,
@@ -69,31 +99,101 @@ void update_net_current_desktop(const Workspace& workspace)
     logger::debug("EWMH -> updated _NET_CURRENT_DESKTOP: {}", workspace.index());
 }
 
-void update_net_client_list(const Manager<::Window>& window_manager)
-{
-    std::vector<uint32_t> window_ids;
-    window_ids.reserve(window_manager.size());
-    for (const auto& [id, _] : window_manager)
-        window_ids.emplace_back(id);
+// Clients in mapping order, and in stacking order from bottom to top.
+static std::vector<xcb_window_t> _clients;
+static std::vector<xcb_window_t> _stacking;
+// Local lists changed, server copies are rewritten by flush_client_list.
+static bool                      _clients_dirty;
+static bool                      _stacking_dirty;
 
+static void _write_client_list(xcb_atom_t property, window::prop mode, std::span<const xcb_window_t> window_ids)
+{
     window::change_property(X11::detail::root_window_id(),
-                            window::prop::replace,
-                            atom::_NET_CLIENT_LIST,
+                            mode,
+                            property,
                             XCB_ATOM_WINDOW,
-                            std::span{window_ids});
-    logger::debug("EWMH -> updated _NET_CLIENT_LIST: {:#x}", fmt::join(window_ids, ", "));
+                            window_ids);
+}
 
-    window::change_property(X11::detail::root_window_id(),
-                            window::prop::replace,
-                            atom::_NET_CLIENT_LIST_STACKING,
-                            XCB_ATOM_WINDOW,
-                            std::span{window_ids});
-    logger::debug("EWMH -> updated _NET_CLIENT_LIST_STACKING: {:#x}", fmt::join(window_ids, ", "));
+void init_net_client_list()
+{
+    _clients.clear();
+    _stacking.clear();
+    _clients_dirty  = false;
+    _stacking_dirty = false;
+    _write_client_list(atom::_NET_CLIENT_LIST, window::prop::replace, {});
+    _write_client_list(atom::_NET_CLIENT_LIST_STACKING, window::prop::replace, {});
+}
+
+void add_client(xcb_window_t window_id)
+{
+    assert(!std::ranges::contains(_clients, window_id));
+    _clients.push_back(window_id);
+    _stacking.push_back(window_id);
+    // New window is mapped on top, both lists only grow at the end.
+    _write_client_list(atom::_NET_CLIENT_LIST, window::prop::append, std::span{&window_id, 1});
+    _write_client_list(atom::_NET_CLIENT_LIST_STACKING, window::prop::append, std::span{&window_id, 1});
+    logger::debug("EWMH -> appended to _NET_CLIENT_LIST: {:#x}", window_id);
+}
+
+void remove_client(xcb_window_t window_id)
+{
+    if (std::erase(_clients, window_id) == 0) return;
+    std::erase(_stacking, window_id);
+    // Removal rewrites the whole list, do it once for all removed clients.
+    _clients_dirty  = true;
+    _stacking_dirty = true;
+    logger::debug("EWMH -> removed from _NET_CLIENT_LIST: {:#x}", window_id);
+}
+
+void flush_client_list()
+{
+    if (_clients_dirty) {
+        _clients_dirty = false;
+        _write_client_list(atom::_NET_CLIENT_LIST, window::prop::replace, _clients);
+        logger::debug("EWMH -> updated _NET_CLIENT_LIST: {:#x}", fmt::join(_clients, ", "));
+    }
+    if (_stacking_dirty) {
+        _stacking_dirty = false;
+        _write_client_list(atom::_NET_CLIENT_LIST_STACKING, window::prop::replace, _stacking);
+        logger::debug("EWMH -> updated _NET_CLIENT_LIST_STACKING: {:#x}", fmt::join(_stacking, ", "));
+    }
+}
+
+void restack_client(xcb_window_t window_id, bool above)
+{
+    const auto it = std::ranges::find(_stacking, window_id);
+    if (it == _stacking.end()) return;
+    if (above ? (it + 1 == _stacking.end()) : (it == _stacking.begin())) return;
+    if (above) std::rotate(it, it + 1, _stacking.end());
+    else       std::rotate(_stacking.begin(), it, it + 1);
+    // Many windows are raised on a workspace switch, write once.
+    _stacking_dirty = true;
+}
+
+#ifndef NDEBUG
+bool is_client_list_stacking_valid()
+{
+    auto tree = memory::c_own<xcb_query_tree_reply_t>(
+        xcb_query_tree_reply(X11::detail::conn(),
+            xcb_query_tree(X11::detail::conn(), X11::detail::root_window_id()), nullptr));
+    if (!tree) return false;
+
+    // Children are listed from bottom to top.
+    std::vector<xcb_window_t> stacking;
+    stacking.reserve(_stacking.size());
+    const std::span children{xcb_query_tree_children(tree.get()),
+                             (std::size_t)xcb_query_tree_children_length(tree.get())};
+    for (const auto child : children)
+        if (std::ranges::contains(_stacking, child)) stacking.push_back(child);
+    return stacking == _stacking;
 }
+#endif
 
 void update_net_number_of_desktops(const Manager<::Workspace>& workspace_manager)
 {
     const uint32_t size[] = { static_cast<uint32_t>(workspace_manager.size()) };
+    if (!_update_cache(_number_of_desktops, size[0])) return;
     window::change_property(X11::detail::root_window_id(),
                             window::prop::replace,
                             atom::_NET_NUMBER_OF_DESKTOPS,
@@ -115,6 +215,7 @@ void update_net_desktop_names(const Manager<::Workspace>& workspace_manager)
         for (const auto& chr : str) buffer.emplace_back(chr);
         buffer.emplace_back('\0');
     }
+    if (!_update_cache(_desktop_names, buffer)) return;
 
     window::change_property(X11::detail::root_window_id(),
                             window::prop::replace,
@@ -124,8 +225,46 @@ void update_net_desktop_names(const Manager<::Workspace>& workspace_manager)
     logger::debug("EWMH -> updated _NET_DESKTOP_NAMES: {}", fmt::join(names, ", "));
 }
 
+void update_net_workarea(const Manager<::Workspace>& workspace_manager)
+{
+    // One x, y, width, height per desktop, indexed like _NET_CURRENT_DESKTOP.
+    // Indices can be sparse, so size by the highest one and give the gaps
+    // the workarea of the first workspace's monitor.
+    if (workspace_manager.empty()) return;
+    uint32_t count = 0;
+    for (const auto&[_, ws] : workspace_manager)
+        count = std::max(count, ws->index() + 1);
+
+    const Vector2D fallback = workspace_manager.begin()->second->monitor().workarea();
+    std::vector<uint32_t> workarea;
+    workarea.reserve(count * 4);
+    for (uint32_t i = 0; i < count; ++i) {
+        workarea.push_back(fallback.pos.x);
+        workarea.push_back(fallback.pos.y);
+        workarea.push_back(fallback.size.x);
+        workarea.push_back(fallback.size.y);
+    }
+    for (const auto&[_, ws] : workspace_manager) {
+        const Vector2D rect = ws->monitor().workarea();
+        const std::size_t i = ws->index() * 4;
+        workarea[i]     = rect.pos.x;
+        workarea[i + 1] = rect.pos.y;
+        workarea[i + 2] = rect.size.x;
+        workarea[i + 3] = rect.size.y;
+    }
+    if (!_update_cache(_workarea, workarea)) return;
+
+    window::change_property(X11::detail::root_window_id(),
+                            window::prop::replace,
+                            atom::_NET_WORKAREA,
+                            XCB_ATOM_CARDINAL,
+                            std::span{workarea});
+    logger::debug("EWMH -> updated _NET_WORKAREA: {}", fmt::join(workarea, ", "));
+}
+
 void update_net_showing_desktop(bool show)
 {
+    if (!_update_cache(_showing_desktop, show)) return;
     const uint32_t prop[] = { show };
     window::change_property(X11::detail::root_window_id(),
                             window::prop::replace,
@@ -134,38 +273,13 @@ void update_net_showing_desktop(bool show)
                             std::span{prop});
 }
 
-void update_net_wm_state_hidden(xcb_window_t window_id, bool hide)
-{
-    const xcb_atom_t atoms[] = { atom::_NET_WM_STATE_HIDDEN };
-    if (hide) {
-        window::change_property(window_id,
-                                window::prop::append,
-                                atom::_NET_WM_STATE_HIDDEN,
-                                XCB_ATOM_WINDOW,
-                                std::span{atoms});
-    } else {
-        xcb_grab_server(X11::detail::conn());
-        auto _ = memory::finally([] () { xcb_ungrab_server(X11::detail::conn()); });
-        auto prop = memory::c_own<xcb_get_property_reply_t>(
-            xcb_get_property_reply(
-                X11::detail::conn(),
-                xcb_get_property(X11::detail::conn(), false, window_id,
-                                 atom::_NET_WM_STATE,
-                                 XCB_GET_PROPERTY_TYPE_ANY, 0, 4096),
-                nullptr));
-        if (!prop || xcb_get_property_value_length(prop.get()) == 0) return;
-
-        auto atom_span = std::span<xcb_atom_t>{
-            (xcb_atom_t*)xcb_get_property_value(prop.get()),
-            (uint32_t)(xcb_get_property_value_length(prop.get()) / (prop->format / 8))
-        };
-        std::ranges::remove(atom_span, atoms[0]);
-        window::change_property(window_id,
-                                window::prop::append,
-                                atom::_NET_WM_STATE_HIDDEN,
-                                XCB_ATOM_WINDOW,
-                                atom_span);
-    }
+void update_net_wm_state(xcb_window_t window_id, std::span<const xcb_atom_t> states)
+{
+    window::change_property(window_id,
+                            window::prop::replace,
+                            atom::_NET_WM_STATE,
+                            XCB_ATOM_ATOM,
+                            states);
 }
 
 }
\ No newline at end of file
@@ -11,6 +11,11 @@ using xcb_window_t = unsigned int;
 
 namespace X11::ewmh {
 
+/**
+ * Root property writes dropped because the value didn't change
+ */
+auto dropped_writes() noexcept -> std::size_t;
+
 /**
  * Update _NET_SUPPORTED
  * @param atoms
@@ -36,10 +41,43 @@ void update_net_active_window(xcb_window_t window_id);
 void update_net_current_desktop(const Workspace& workspace);
 
 /**
- * Update _NET_CLIENT_LIST
- * @param window_manager
+ * Clear _NET_CLIENT_LIST and _NET_CLIENT_LIST_STACKING left by previous wm
+ */
+void init_net_client_list();
+
+/**
+ * Append client to _NET_CLIENT_LIST and on top of _NET_CLIENT_LIST_STACKING
+ * @param window_id
  */
-void update_net_client_list(const Manager<::Window>& window_manager);
+void add_client(xcb_window_t window_id);
+
+/**
+ * Remove client from _NET_CLIENT_LIST and _NET_CLIENT_LIST_STACKING
+ * Properties are written by flush_client_list
+ * @param window_id
+ */
+void remove_client(xcb_window_t window_id);
+
+/**
+ * Rewrite _NET_CLIENT_LIST and _NET_CLIENT_LIST_STACKING if they were changed
+ */
+void flush_client_list();
+
+/**
+ * Move client to top or bottom of _NET_CLIENT_LIST_STACKING
+ * Property is written by flush_client_list
+ * @param window_id
+ * @param above
+ */
+void restack_client(xcb_window_t window_id, bool above);
+
+#ifndef NDEBUG
+/**
+ * Check _NET_CLIENT_LIST_STACKING against the stacking order of the server
+ * Needs a round trip, only for debugging
+ */
+bool is_client_list_stacking_valid();
+#endif
 
 /**
  * Update _NET_DESKTOP_NAMES
@@ -53,6 +91,12 @@ void update_net_desktop_names(const Manager<::Workspace>& workspace_manager);
  */
 void update_net_number_of_desktops(const Manager<::Workspace>& workspace_manager);
 
+/**
+ * Update _NET_WORKAREA, the workarea of each workspace's monitor
+ * @param workspace_manager
+ */
+void update_net_workarea(const Manager<::Workspace>& workspace_manager);
+
 /**
  * Update _NET_SHOWING_DESKTOP
  * @param show
@@ -60,10 +104,10 @@ void update_net_number_of_desktops(const Manager<::Workspace>& workspace_manager
 void udpate_net_showing_desktop(bool show);
 
 /**
- * Update _NET_WM_STATE for _NET_WM_STATE_HIDDEN
+ * Update _NET_WM_STATE, replacing the whole property
  * @param window_id
- * @param hide
+ * @param states
  */
-void update_net_wm_state_hidden(xcb_window_t window_id, bool hide);
+void update_net_wm_state(xcb_window_t window_id, std::span<const xcb_atom_t> states);
 
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "monitor.h"
 #include "atom.h"
+#include "ewmh.h"
 #include "extension.h"
 #include "x11.h"
 #include "../config.h"
@@ -22,6 +23,9 @@ struct XRandR_output
     std::vector<xcb_randr_output_t> outputs;
 };
 
+// Pending screen change, applied once the burst of RandR events is read.
+static bool _screen_change_pending;
+
 static void _load_all_xinerama(State&)
 {
 
@@ -46,7 +50,9 @@ static auto _get_randr_monitor_outputs(xcb_randr_monitor_info_t& data) -> XRandR
     return rnr_output;
 }
 
-static void _load_all_xrandr_monitors(State& state)
+// Calls found(index, name, rect) for each monitor.
+template <typename Func>
+static void _scan_xrandr_monitors(State& state, Func&& found)
 {
     auto monitors = memory::c_own(xcb_randr_get_monitors_reply(
             state.conn(),
@@ -61,8 +67,7 @@ static void _load_all_xrandr_monitors(State& state)
          monitor_iter.rem; xcb_randr_monitor_info_next(&monitor_iter)) {
         const auto output = _get_randr_monitor_outputs(*monitor_iter.data);
 
-        Monitor& mon = state.monitors().manage(i, output.name);
-        mon.rect({
+        found(i, output.name, Vector2D{
             {monitor_iter.data->x, monitor_iter.data->y},
             {monitor_iter.data->width, monitor_iter.data->height}
         });
@@ -72,7 +77,8 @@ static void _load_all_xrandr_monitors(State& state)
     }
 }
 #else
-static void _load_all_xrandr_monitors(State&) {}
+template <typename Func>
+static void _scan_xrandr_monitors(State&, Func&&) {}
 #endif
 
 static auto _get_randr_crtc_outputs(xcb_randr_get_crtc_info_reply_t& crtc_info) -> std::vector<XRandR_output>
@@ -102,7 +108,8 @@ static auto _get_randr_crtc_outputs(xcb_randr_get_crtc_info_reply_t& crtc_info)
     return rnr_outputs;
 }
 
-static void _load_all_xrandr_crtcs(State& state)
+template <typename Func>
+static void _scan_xrandr_crtcs(State& state, Func&& found)
 {
     auto screen_res = memory::c_own(xcb_randr_get_screen_resources_reply(
             state.conn(),
@@ -136,8 +143,7 @@ static void _load_all_xrandr_crtcs(State& state)
             return !output.name.empty();
         });
 
-        Monitor& mon = state.monitors().manage(i, (it != outputs.cend()) ? it->name : "unknown");
-        mon.rect({
+        found(i, (it != outputs.cend()) ? it->name : "unknown", Vector2D{
             {crtc_info->x, crtc_info->y},
             {crtc_info->width, crtc_info->height}
         });
@@ -146,16 +152,27 @@ static void _load_all_xrandr_crtcs(State& state)
     }
 }
 
-static void _load_all_xrandr(State& state)
+template <typename Func>
+static void _scan_xrandr(State& state, Func&& found)
 {
-    xcb_randr_select_input(state.conn(), X11::root_window_id(state.conn()), XCB_RANDR_NOTIFY_MASK_OUTPUT_CHANGE);
     if (extension::xrandr().have_randr_15) {
-        logger::debug("_load_all_xrandr -> load monitors");
-        _load_all_xrandr_monitors(state);
+        logger::debug("_scan_xrandr -> scan monitors");
+        _scan_xrandr_monitors(state, found);
     } else {
-        logger::debug("_load_all_xrandr -> load crtcs");
-        _load_all_xrandr_crtcs(state);
+        logger::debug("_scan_xrandr -> scan crtcs");
+        _scan_xrandr_crtcs(state, found);
     }
+}
+
+static void _load_all_xrandr(State& state)
+{
+    xcb_randr_select_input(state.conn(), X11::root_window_id(state.conn()),
+                           XCB_RANDR_NOTIFY_MASK_SCREEN_CHANGE
+                         | XCB_RANDR_NOTIFY_MASK_CRTC_CHANGE
+                         | XCB_RANDR_NOTIFY_MASK_OUTPUT_CHANGE);
+    _scan_xrandr(state, [&](int i, const std::string& name, const Vector2D& rect) {
+        state.monitors().manage(i, name, state.workspaces()).rect(rect);
+    });
     if (state.monitors().empty()) {
         xcb_randr_select_input(state.conn(), X11::root_window_id(state.conn()), 0);
     }
@@ -174,7 +191,7 @@ void load_all(State& state)
     if (state.monitors().empty()) {
         logger::debug("Monitor is still empty, use default screen configuration");
         // update default monitor.
-        Monitor& mon = state.monitors().manage(0, "default");
+        Monitor& mon = state.monitors().manage(0, "default", state.workspaces());
         const xcb_screen_t* xscreen = state.conn().xscreen();
         mon.rect({
             {0, 0},
@@ -183,4 +200,31 @@ void load_all(State& state)
     }
 }
 
+void screen_changed() noexcept
+{
+    _screen_change_pending = true;
+}
+
+bool commit_screen_change(State& state)
+{
+    if (!_screen_change_pending) return false;
+    _screen_change_pending = false;
+
+    // Monitors keep their workspaces, only their geometry follows the screen.
+    std::size_t found_count = 0;
+    _scan_xrandr(state, [&](int i, const std::string& name, const Vector2D& rect) {
+        ++found_count;
+        if (!state.monitors().contains(i)) return;
+        logger::debug("Screen change -> monitor: {}, x: {}, y: {}, width: {}, height: {}",
+                      name, rect.pos.x, rect.pos.y, rect.size.x, rect.size.y);
+        state.monitors().at(i).assign_rect(rect);
+    });
+    if (found_count != state.monitors().size())
+        logger::error("Screen change -> monitors plugged or unplugged, only known ones are laid out");
+
+    ::monitor::update_rect_all(state.monitors());
+    ewmh::update_net_workarea(state.workspaces());
+    return true;
+}
+
 } // namespace X11::monitor
\ No newline at end of file
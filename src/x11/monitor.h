@@ -8,4 +8,18 @@ namespace X11::monitor {
 
 void load_all(State& state);
 
+/**
+ * @brief Mark screen geometry as changed, on RandR notify.
+ * Many notifies come for one change, so nothing is done yet.
+ */
+void screen_changed() noexcept;
+
+/**
+ * @brief Read monitor geometry again and lay out all monitors, if the screen changed.
+ * Call once pending events are handled.
+ * @param state
+ * @return true if monitors were laid out again
+ */
+bool commit_screen_change(State& state);
+
 } // namespace X11::monitor
\ No newline at end of file
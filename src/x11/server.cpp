@@ -1,5 +1,6 @@
 #include "server.h"
 #include "event.h"
+#include "ewmh.h"
 #include "monitor.h"
 #include "window.h"
 #include "xkb.h"
@@ -40,6 +41,12 @@ static void _main_loop(Server& server, State& state)
     FD_ZERO(&in_fds);
     FD_SET(xcb_fd, &in_fds);
 
+    // Fence layout done while starting up.
+    X11::event::commit_layout();
+    X11::event::commit_focus(state);
+    X11::ewmh::flush_client_list();
+    state.conn().flush();
+
     while (server.is_running()) {
         // Freezes until signal
         select(xcb_fd + 1, &in_fds, nullptr, nullptr, nullptr);
@@ -52,6 +59,14 @@ static void _main_loop(Server& server, State& state)
             X11::event::handle(state, { ev });
             free(ev);
             ev = nullptr;
+            X11::event::commit_layout();
+            X11::event::commit_focus(state);
+            X11::ewmh::flush_client_list();
+            state.conn().flush();
+        }
+        // Screen changes come in bursts, lay out once all of them are read.
+        if (X11::monitor::commit_screen_change(state)) {
+            X11::event::commit_layout();
             state.conn().flush();
         }
     }
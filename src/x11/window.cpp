@@ -9,6 +9,8 @@
 #include "../config.h"
 #include "../logger.h"
 
+#include <algorithm>
+#include <cstring>
 #include <limits>
 #include <xcb/shape.h>
 #include <xcb/xcb_icccm.h>
@@ -133,6 +135,57 @@ static void fetch_protocols(const xcb_window_t window_id, std::vector<uint32_t>&
     protocols = { proto.atoms, proto.atoms + proto.atoms_len };
 }
 
+static void fetch_normal_hints(const xcb_window_t window_id, xcb_size_hints_t& hints)
+{
+    if (!xcb_icccm_get_wm_normal_hints_reply(
+            X11::detail::conn(),
+            xcb_icccm_get_wm_normal_hints(X11::detail::conn(), window_id),
+            &hints,
+            nullptr))
+        hints = {};
+}
+
+static void fetch_net_wm_state(const xcb_window_t window_id, std::vector<xcb_atom_t>& states)
+{
+    auto prop = memory::c_own<xcb_get_property_reply_t>(
+        xcb_get_property_reply(
+            X11::detail::conn(),
+            xcb_get_property(X11::detail::conn(), false, window_id,
+                             X11::atom::_NET_WM_STATE,
+                             XCB_ATOM_ATOM, 0,
+                             std::numeric_limits<uint32_t>::max()),
+            nullptr));
+    if (!prop) return;
+
+    const xcb_atom_t* atoms  = reinterpret_cast<xcb_atom_t*>(xcb_get_property_value(prop.get()));
+    const std::size_t length = xcb_get_property_value_length(prop.get()) / sizeof(xcb_atom_t);
+    states.assign(atoms, atoms + length);
+}
+
+// Strut of the monitor containing the dock, _NET_WM_STRUT_PARTIAL is relative to root edges.
+static void fetch_strut(const xcb_window_t window_id, const Monitor& monitor, Strut& strut)
+{
+    auto prop = memory::c_own<xcb_get_property_reply_t>(
+        xcb_get_property_reply(
+            X11::detail::conn(),
+            xcb_get_property(X11::detail::conn(), false, window_id,
+                             X11::atom::_NET_WM_STRUT_PARTIAL,
+                             XCB_ATOM_CARDINAL, 0, 12),
+            nullptr));
+    strut = {};
+    if (!prop || xcb_get_property_value_length(prop.get()) < 4 * (int)sizeof(uint32_t)) return;
+
+    const auto* values  = reinterpret_cast<uint32_t*>(xcb_get_property_value(prop.get()));
+    const auto* xscreen = X11::detail::conn().xscreen();
+    const auto& rect    = monitor.rect();
+    const int root_right  = xscreen->width_in_pixels  - (rect.pos.x + rect.size.x);
+    const int root_bottom = xscreen->height_in_pixels - (rect.pos.y + rect.size.y);
+    strut.left   = std::clamp((int)values[0] - rect.pos.x,  0, rect.size.x);
+    strut.right  = std::clamp((int)values[1] - root_right,  0, rect.size.x);
+    strut.top    = std::clamp((int)values[2] - rect.pos.y,  0, rect.size.y);
+    strut.bottom = std::clamp((int)values[3] - root_bottom, 0, rect.size.y);
+}
+
 static void init_xprop(const uint32_t window_id, X11_window_property& xprop)
 {
     fetch_name(window_id, xprop.name);
@@ -141,10 +194,56 @@ static void init_xprop(const uint32_t window_id, X11_window_property& xprop)
     fetch_class_and_instance(window_id, xprop.wm_class);
     fetch_wm_hints(window_id, xprop.wm_hints);
     fetch_protocols(window_id, xprop.protocols);
+    fetch_normal_hints(window_id, xprop.normal_hints);
+    fetch_net_wm_state(window_id, xprop.net_wm_state);
 }
 
 } // namespace window
 
+// Fit size to WM_NORMAL_HINTS, the same way as ICCCM 4.1.2.3 describes.
+static auto _constrain_size(const xcb_size_hints_t& hints, Point2D size) noexcept -> Point2D
+{
+    Point2D base = {};
+    Point2D min  = {};
+    // Each falls back to the other when missing.
+    if (hints.flags & XCB_ICCCM_SIZE_HINT_BASE_SIZE)
+        base = { hints.base_width, hints.base_height };
+    else if (hints.flags & XCB_ICCCM_SIZE_HINT_P_MIN_SIZE)
+        base = { hints.min_width, hints.min_height };
+    if (hints.flags & XCB_ICCCM_SIZE_HINT_P_MIN_SIZE)
+        min = { hints.min_width, hints.min_height };
+    else if (hints.flags & XCB_ICCCM_SIZE_HINT_BASE_SIZE)
+        min = base;
+
+    // Aspect ratio doesn't count the base size, shrink to fit.
+    // Unlike increments, min size must not stand in for a missing base here.
+    if (hints.flags & XCB_ICCCM_SIZE_HINT_P_ASPECT
+     && hints.min_aspect_den > 0 && hints.max_aspect_den > 0
+     && hints.min_aspect_num > 0 && hints.max_aspect_num > 0) {
+        const Point2D aspect_base = (hints.flags & XCB_ICCCM_SIZE_HINT_BASE_SIZE) ? base : Point2D{};
+        const long w = size.x - aspect_base.x;
+        const long h = size.y - aspect_base.y;
+        if (w * hints.min_aspect_den < h * hints.min_aspect_num)
+            size.y = aspect_base.y + int(w * hints.min_aspect_den / hints.min_aspect_num);
+        else if (w * hints.max_aspect_den > h * hints.max_aspect_num)
+            size.x = aspect_base.x + int(h * hints.max_aspect_num / hints.max_aspect_den);
+    }
+
+    if (hints.flags & XCB_ICCCM_SIZE_HINT_P_RESIZE_INC) {
+        if (hints.width_inc > 0 && size.x > base.x)
+            size.x -= (size.x - base.x) % hints.width_inc;
+        if (hints.height_inc > 0 && size.y > base.y)
+            size.y -= (size.y - base.y) % hints.height_inc;
+    }
+
+    size = { std::max(size.x, min.x), std::max(size.y, min.y) };
+    if (hints.flags & XCB_ICCCM_SIZE_HINT_P_MAX_SIZE) {
+        if (hints.max_width  > 0) size.x = std::min(size.x, hints.max_width);
+        if (hints.max_height > 0) size.y = std::min(size.y, hints.max_height);
+    }
+    return { std::max(size.x, 1), std::max(size.y, 1) };
+}
+
 // X11 Window implementations
 Window_impl::Window_impl(const Window& window)
     : _window(window)
@@ -164,24 +263,72 @@ Window_impl::Window_impl(const Window& window)
 
     xcb_change_save_set(X11::detail::conn(), XCB_SET_MODE_INSERT, window.index());
     xcb_map_window(X11::detail::conn(), window.index());
+    ewmh::add_client(window.index());
+    window::raise(window.index());
+}
+
+void Window_impl::_set_net_wm_state(const xcb_atom_t state, const bool enable) noexcept
+{
+    auto& states = _xprop.net_wm_state;
+    if (std::ranges::contains(states, state) == enable) return;
+    if (enable) states.push_back(state);
+    else        std::erase(states, state);
+    // Local state is authoritative, no need to read it back.
+    ewmh::update_net_wm_state(_window.index(), states);
 }
 
 void Window_impl::update_rect() noexcept
 {
-    if (_window.state() != Window::State::Normal) return;
-    switch (_window.placement_mode()) {
-    case Window::Placement_mode::Tiling:
-        window::configure_rect(_window.index(), {
-            { _window.rect().pos.x + (int)config::GAP_SIZE, _window.rect().pos.y + (int)config::GAP_SIZE },
-            { _window.rect().size.x - 2*(int)config::GAP_SIZE, _window.rect().size.y - 2*(int)config::GAP_SIZE }
-        });
-        break;
-    case Window::Placement_mode::Floating:
-    case Window::Placement_mode::Sticky:
-        window::configure_rect(_window.index(), _window.rect());
-        break;
+    if (_window.state() != Window::State::Normal) {
+        _stale_rect = true;
+        return;
     }
+    _stale_rect = false;
+    _configure(frame_rect());
+}
 
+void Window_impl::_configure(const Vector2D& rect) noexcept
+{
+    _configured_rect = rect;
+    window::configure_rect(_window.index(), rect);
+}
+
+auto Window_impl::frame_rect() const noexcept -> Vector2D
+{
+    Vector2D rect = _window.rect();
+    if (_window.placement_mode() == Window::Placement_mode::Tiling) {
+        rect.pos.x  += (int)config::gap_size;
+        rect.pos.y  += (int)config::gap_size;
+        rect.size.x -= 2*(int)config::gap_size;
+        rect.size.y -= 2*(int)config::gap_size;
+    }
+    // Settle the size here, so client doesn't need to resize itself again.
+    rect.size = _constrain_size(_xprop.normal_hints, rect.size);
+    return rect;
+}
+
+void Window_impl::update_normal_hints() noexcept
+{
+    xcb_size_hints_t hints{};
+    window::detail::fetch_normal_hints(_window.index(), hints);
+    if (std::memcmp(&hints, &_xprop.normal_hints, sizeof(hints)) == 0) return;
+    _xprop.normal_hints = hints;
+    logger::debug("Window normal hints -> updated for window: {:#x}", _window.index());
+    update_rect();
+}
+
+void Window_impl::count_configure_request() noexcept
+{
+    const auto now = std::chrono::steady_clock::now();
+    if (now - _configure_requests_since >= std::chrono::seconds(1)) {
+        _configure_requests       = 0;
+        _configure_requests_since = now;
+    }
+    if (++_configure_requests > config::X11::CONFIGURE_REQUEST_LIMIT && !_configure_requests_flagged) {
+        _configure_requests_flagged = true;
+        logger::info("Configure request -> window {:#x} sent over {} requests in a second",
+                     _window.index(), config::X11::CONFIGURE_REQUEST_LIMIT);
+    }
 }
 
 void Window_impl::update_focus() noexcept
@@ -194,25 +341,42 @@ void Window_impl::update_focus() noexcept
             logger::debug("Window focus -> setting input focus to window : {:#x}", _window.index());
             window::set_input_focus(_window.index());
         }
-        X11::ewmh::update_net_active_window(_window.index());
+        // Tiled windows don't overlap, only floating ones need to be on top.
+        if (_window.placement_mode() != Window::Placement_mode::Tiling)
+            window::raise(_window.index());
     } else {
         xcb_set_input_focus(X11::detail::conn(), XCB_INPUT_FOCUS_POINTER_ROOT, X11::detail::main_window_id(),
                             XCB_CURRENT_TIME);
-        X11::ewmh::update_net_active_window(XCB_NONE);
     }
+    // Unfocus of the last window comes right before focus of the next one,
+    // _NET_ACTIVE_WINDOW is written once both are done.
+    event::focus_changed();
 }
 
 void Window_impl::update_state(Window::State wstate) noexcept
 {
     switch (wstate) {
     case Window::State::Normal:
-        ewmh::update_net_wm_state_hidden(_window.index(), false);
+        _set_net_wm_state(atom::_NET_WM_STATE_HIDDEN, false);
+        // Configure before map, so the window shows up in place.
+        // Off-screen windows must be moved back anyway.
+        if (_stale_rect || config::hide_mode == config::Hide_mode::Offscreen) update_rect();
+        // Off-screen windows stay mapped, moving them back is enough.
+        if (config::hide_mode == config::Hide_mode::Offscreen) break;
         xcb_map_window(X11::detail::conn(), _window.index());
+        window::raise(_window.index());
         break;
     case Window::State::Minimized:
-        ewmh::update_net_wm_state_hidden(_window.index(), true);
+        _set_net_wm_state(atom::_NET_WM_STATE_HIDDEN, true);
+        if (config::hide_mode == config::Hide_mode::Offscreen) {
+            // Still mapped, so client keeps its buffers and doesn't redraw when shown.
+            const Vector2D rect = frame_rect();
+            _configure({ { -rect.size.x, rect.pos.y }, rect.size });
+            break;
+        }
         event::ignore_unmap(_window.index());
         xcb_unmap_window(X11::detail::conn(), _window.index());
+        event::layout_changed();
         break;
     case Window::State::Maximized:
         // Make the window fullscreen.
@@ -245,6 +409,7 @@ Window_impl::~Window_impl() noexcept
         xcb_shape_select_input(detail::conn(), _window.index(), XCB_NONE);
     }
     xcb_change_save_set(detail::conn(), XCB_SET_MODE_DELETE, _window.index());
+    ewmh::remove_client(_window.index());
 }
 
 
@@ -287,6 +452,35 @@ void configure_rect(const uint32_t window_id, const Vector2D& rect) noexcept
     };
 
     xcb_configure_window(X11::detail::conn(), window_id, mask, values);
+    event::layout_changed();
+}
+
+void raise(const uint32_t window_id) noexcept
+{
+    const uint32_t values[] = { XCB_STACK_MODE_ABOVE };
+    xcb_configure_window(X11::detail::conn(), window_id, XCB_CONFIG_WINDOW_STACK_MODE, values);
+    ewmh::restack_client(window_id, true);
+    event::layout_changed();
+}
+
+void send_configure_notify(const uint32_t window_id, const Vector2D& rect) noexcept
+{
+    const xcb_configure_notify_event_t event = {
+        .response_type     = XCB_CONFIGURE_NOTIFY,
+        .pad0              = 0,
+        .sequence          = 0,
+        .event             = window_id,
+        .window            = window_id,
+        .above_sibling     = XCB_NONE,
+        .x                 = static_cast<int16_t>(rect.pos.x),
+        .y                 = static_cast<int16_t>(rect.pos.y),
+        .width             = static_cast<uint16_t>(rect.size.x),
+        .height            = static_cast<uint16_t>(rect.size.y),
+        .border_width      = 0,
+        .override_redirect = false,
+        .pad1              = 0
+    };
+    xcb_send_event(X11::detail::conn(), false, window_id, XCB_EVENT_MASK_STRUCTURE_NOTIFY, (const char*)&event);
 }
 
 void grab_keys(const uint32_t window_id, const State& state) noexcept
@@ -341,7 +535,44 @@ static auto _fetch_workspace(const uint32_t window_id) -> uint32_t
     return reinterpret_cast<uint32_t*>(xcb_get_property_value(prop.get()))[0];
 }
 
-static void _manage(const uint32_t window_id, State& state, Workspace& workspace, const bool is_starting_up)
+static auto _dock_monitor(const uint32_t window_id, const State& state) -> Monitor&
+{
+    if (const auto geometry = get_geometry(window_id)) {
+        const Point2D center = {
+            geometry->x + geometry->width / 2,
+            geometry->y + geometry->height / 2
+        };
+        for (const auto& [_, monitor] : state.monitors()) {
+            const auto& rect = monitor->rect();
+            if (rect.pos.x <= center.x && center.x < rect.pos.x + rect.size.x
+             && rect.pos.y <= center.y && center.y < rect.pos.y + rect.size.y)
+                return *monitor;
+        }
+    }
+    return state.current_monitor();
+}
+
+// Docks aren't windows in the tree, they only reserve space of their monitor.
+static void _manage_dock(const uint32_t window_id, State& state)
+{
+    if (::monitor::find_dock(state.monitors(), window_id)) return;
+
+    // Only need to know when it goes away or changes its strut.
+    const uint32_t mask_values[] = { XCB_EVENT_MASK_PROPERTY_CHANGE | XCB_EVENT_MASK_STRUCTURE_NOTIFY };
+    window::change_attributes(window_id, XCB_CW_EVENT_MASK, std::span{mask_values});
+
+    Monitor& monitor = _dock_monitor(window_id, state);
+    Strut strut;
+    detail::fetch_strut(window_id, monitor, strut);
+    logger::debug("Manage dock -> window: {:#x}, monitor: {}, strut: {} {} {} {}", window_id, monitor.name(),
+                  strut.left, strut.right, strut.top, strut.bottom);
+
+    monitor.add_dock(window_id, strut);
+    ewmh::update_net_workarea(state.workspaces());
+    xcb_map_window(X11::detail::conn(), window_id);
+}
+
+static void _manage(const uint32_t window_id, State& state, const bool is_starting_up)
 {
     if (state.windows().contains(window_id)) {
         logger::debug("Can't manage window -> already managed");
@@ -358,8 +589,17 @@ static void _manage(const uint32_t window_id, State& state, Workspace& workspace
         return;
     }
 
+    xcb_atom_t type = XCB_NONE;
+    detail::fetch_type(window_id, type);
+    if (type == X11::atom::_NET_WM_WINDOW_TYPE_DOCK) {
+        _manage_dock(window_id, state);
+        return;
+    }
+
     try {
         if (is_starting_up) {
+            // Docks are often on all desktops, so only look it up for windows.
+            Workspace& workspace = state.get_or_create_workspace(_fetch_workspace(window_id));
             Window& window = state.windows().manage(window_id, Window::Display_type::X11);
             ::window::move_to_workspace(window, workspace);
         } else {
@@ -378,17 +618,41 @@ static void _manage(const uint32_t window_id, State& state, Workspace& workspace
 void load_all(State& state)
 {
     auto [_, window_ids] = window::_fetch_all();
+    // Notify observers once for all windows.
+    const auto batch = state.batch();
     xcb_grab_server(X11::detail::conn());
-    for (auto window_id : window_ids) {
-        Workspace& workspace = state.get_or_create_workspace(_fetch_workspace(window_id));
-        window::_manage(window_id, state, workspace, true);
-    }
+    for (auto window_id : window_ids)
+        window::_manage(window_id, state, true);
     xcb_ungrab_server(X11::detail::conn());
 }
 
 void manage(const uint32_t window_id, State& state)
 {
-    _manage(window_id, state, state.current_workspace(), false);
+    _manage(window_id, state, false);
+}
+
+bool unmanage_dock(const uint32_t window_id, State& state)
+{
+    // Docks go away with their monitor.
+    const auto& monref = ::monitor::find_dock(state.monitors(), window_id);
+    if (!monref) return false;
+
+    monref->get().remove_dock(window_id);
+    ewmh::update_net_workarea(state.workspaces());
+    logger::debug("Unmanage dock -> window: {:#x}", window_id);
+    return true;
+}
+
+void update_dock(const uint32_t window_id, State& state)
+{
+    const auto& monref = ::monitor::find_dock(state.monitors(), window_id);
+    if (!monref) return;
+    Monitor& monitor = monref->get();
+
+    Strut strut;
+    detail::fetch_strut(window_id, monitor, strut);
+    if (monitor.update_dock(window_id, strut))
+        ewmh::update_net_workarea(state.workspaces());
 }
 
 void send_take_focus(const uint32_t window_id) noexcept
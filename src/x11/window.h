@@ -3,6 +3,7 @@
 #include "../window.h"
 #include "../helper/memory.h"
 
+#include <chrono>
 #include <span>
 #include <vector>
 #include <xcb/xcb_icccm.h>
@@ -18,6 +19,9 @@ struct X11_window_property
     std::string           role;
     xcb_icccm_wm_hints_t  wm_hints{};
     std::vector<uint32_t> protocols;
+    xcb_size_hints_t      normal_hints{};
+    // Authoritative _NET_WM_STATE, fetched once when managed.
+    std::vector<uint32_t> net_wm_state;
     struct WM_class
     {
         std::string wclass;
@@ -43,10 +47,46 @@ class Window_impl final : public ::Window::Impl
     const Window&       _window;
     X11_window_property _xprop;
     bool                _do_not_focus;
+    // Rect changed while window is not shown.
+    bool                _stale_rect{};
+    // Rect last sent to the server, off-screen if hidden there.
+    Vector2D            _configured_rect{};
+    // ConfigureRequests since the start of the last second,
+    // to spot clients resizing themselves in a loop.
+    uint32_t                              _configure_requests{};
+    std::chrono::steady_clock::time_point _configure_requests_since{};
+    bool                                  _configure_requests_flagged{};
+
+    // Configure window and remember its rect.
+    void _configure(const Vector2D& rect) noexcept;
+
+    // Add or remove state and rewrite _NET_WM_STATE if it changed.
+    void _set_net_wm_state(uint32_t state, bool enable) noexcept;
 
 public:
     explicit Window_impl(const Window& window);
 
+    /**
+     * @brief Rect X11 window is configured with.
+     * Tiled windows leave a gap, size is fit to WM_NORMAL_HINTS.
+     * @return Vector2D
+     */
+    auto frame_rect() const noexcept -> Vector2D;
+
+    // Geometry window really has on the server.
+    inline auto configured_rect() const noexcept -> const Vector2D&
+    { return _configured_rect; }
+
+    /**
+     * @brief Refetch WM_NORMAL_HINTS, reconfigure window if they changed.
+     */
+    void update_normal_hints() noexcept;
+
+    /**
+     * @brief Count a ConfigureRequest, log once if the window sends too many.
+     */
+    void count_configure_request() noexcept;
+
     void update_rect()                      noexcept override;
     void update_focus()                     noexcept override;
     void update_state(Window::State wstate) noexcept override;
@@ -88,6 +128,19 @@ auto get_geometry(uint32_t window_id) noexcept
  */
 void configure_rect(uint32_t window_id, const Vector2D& rect) noexcept;
 
+/**
+ * @brief Raise X11 window on top, and on top of _NET_CLIENT_LIST_STACKING
+ * @param window_id
+ */
+void raise(uint32_t window_id) noexcept;
+
+/**
+ * @brief Send synthetic ConfigureNotify, telling window its geometry without moving it.
+ * @param window_id
+ * @param rect
+ */
+void send_configure_notify(uint32_t window_id, const Vector2D& rect) noexcept;
+
 /**
  * @brief Grab all keys for an X11 window
  * @param window_id
@@ -115,6 +168,21 @@ void load_all(State& state);
  */
 void manage(uint32_t window_id, State& state);
 
+/**
+ * @brief Stop tracking a dock and release its reserved space.
+ * @param window_id
+ * @param state
+ * @return false if window is not a dock
+ */
+bool unmanage_dock(uint32_t window_id, State& state);
+
+/**
+ * @brief Refetch dock strut and lay out its monitor if it changed.
+ * @param window_id
+ * @param state
+ */
+void update_dock(uint32_t window_id, State& state);
+
 /**
  * @brief Send WM_TAKE_FOCUS protocol to a window
  * @param window_id